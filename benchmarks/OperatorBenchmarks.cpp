@@ -0,0 +1,193 @@
+#include <thread>
+
+#include "pushmi/o/defer.h"
+#include "pushmi/o/filter.h"
+#include "pushmi/o/just.h"
+#include "pushmi/o/measure.h"
+#include "pushmi/o/on.h"
+#include "pushmi/o/share.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/tap.h"
+#include "pushmi/o/transform.h"
+#include "pushmi/o/via.h"
+
+#include "pushmi/trampoline.h"
+
+#include "pool.h"
+
+#include "benchmark.h"
+
+using namespace pushmi::aliases;
+
+// one group per operator, each benchmark submits a whole pipeline to a
+// receiver, so ns/op and allocs/op are those of building and running it.
+
+namespace {
+
+// in | transform | ... with N transforms.
+template <std::size_t N>
+struct transforms {
+  template <class In>
+  auto operator()(In in) const {
+    return transforms<N - 1>{}(
+      std::move(in) | op::transform([](int v) { return v + 1; }));
+  }
+};
+template <>
+struct transforms<0> {
+  template <class In>
+  In operator()(In in) const {
+    return in;
+  }
+};
+
+template <std::size_t N>
+void transform_depth(pushmi_benchmarks::chronometer& meter) {
+  int result = 0;
+  meter.measure([&] {
+    transforms<N>{}(op::just(pushmi_benchmarks::opaque(1))) |
+      op::submit([&](int v) { result = v; });
+    return result;
+  });
+}
+
+template <std::size_t N>
+void share_fan_out(pushmi_benchmarks::chronometer& meter) {
+  int result = 0;
+  meter.measure([&] {
+    auto shared = op::just(pushmi_benchmarks::opaque(1)) | op::share<int>();
+    for (std::size_t i = 0; i < N; ++i) {
+      shared | op::submit([&](int v) { result += v; });
+    }
+    return result;
+  });
+}
+
+mi::pool& pool() {
+  static mi::pool pl{std::max(1u, std::thread::hardware_concurrency())};
+  return pl;
+}
+
+} // namespace
+
+PUSHMI_BENCHMARK("just", [](pushmi_benchmarks::chronometer& meter){
+  int result = 0;
+  meter.measure([&]{
+    op::just(pushmi_benchmarks::opaque(1)) | op::submit([&](int v) { result = v; });
+    return result;
+  });
+})
+
+PUSHMI_BENCHMARK("transform depth 1", transform_depth<1>)
+PUSHMI_BENCHMARK("transform depth 4", transform_depth<4>)
+PUSHMI_BENCHMARK("transform depth 16", transform_depth<16>)
+
+PUSHMI_BENCHMARK("filter pass", [](pushmi_benchmarks::chronometer& meter){
+  int result = 0;
+  meter.measure([&]{
+    op::just(pushmi_benchmarks::opaque(1)) |
+      op::filter([](int v) { return v > 0; }) |
+      op::submit([&](int v) { result = v; });
+    return result;
+  });
+})
+
+PUSHMI_BENCHMARK("filter reject", [](pushmi_benchmarks::chronometer& meter){
+  int result = 0;
+  meter.measure([&]{
+    op::just(pushmi_benchmarks::opaque(1)) |
+      op::filter([](int v) { return v < 0; }) |
+      op::submit(
+        v::on_value([&](int v) { result = v; }),
+        v::on_error([](auto) noexcept {}),
+        v::on_done([&] { ++result; }));
+    return result;
+  });
+})
+
+PUSHMI_BENCHMARK("tap", [](pushmi_benchmarks::chronometer& meter){
+  int result = 0;
+  int tapped = 0;
+  meter.measure([&]{
+    op::just(pushmi_benchmarks::opaque(1)) |
+      op::tap([&](int v) { tapped += v; }) |
+      op::submit([&](int v) { result = v; });
+    return result + tapped;
+  });
+})
+
+PUSHMI_BENCHMARK("via trampoline", [](pushmi_benchmarks::chronometer& meter){
+  int result = 0;
+  meter.measure([&]{
+    op::just(pushmi_benchmarks::opaque(1)) |
+      op::via([]{ return mi::trampoline(); }) |
+      op::submit([&](int v) { result = v; });
+    return result;
+  });
+})
+
+PUSHMI_BENCHMARK("via pool", [](pushmi_benchmarks::chronometer& meter){
+  auto pe = pool().executor();
+  meter.measure([&]{
+    return op::just(pushmi_benchmarks::opaque(1)) |
+      op::via([pe]{ return pe; }) |
+      op::get<int>;
+  });
+})
+
+PUSHMI_BENCHMARK("on trampoline", [](pushmi_benchmarks::chronometer& meter){
+  int result = 0;
+  meter.measure([&]{
+    op::just(pushmi_benchmarks::opaque(1)) |
+      op::on([]{ return mi::trampoline(); }) |
+      op::submit([&](int v) { result = v; });
+    return result;
+  });
+})
+
+PUSHMI_BENCHMARK("on pool", [](pushmi_benchmarks::chronometer& meter){
+  auto pe = pool().executor();
+  meter.measure([&]{
+    return op::just(pushmi_benchmarks::opaque(1)) |
+      op::on([pe]{ return pe; }) |
+      op::get<int>;
+  });
+})
+
+PUSHMI_BENCHMARK("share fan-out 1", share_fan_out<1>)
+PUSHMI_BENCHMARK("share fan-out 4", share_fan_out<4>)
+PUSHMI_BENCHMARK("share fan-out 16", share_fan_out<16>)
+
+PUSHMI_BENCHMARK("defer", [](pushmi_benchmarks::chronometer& meter){
+  int result = 0;
+  meter.measure([&]{
+    op::defer([]{ return op::just(pushmi_benchmarks::opaque(1)); }) |
+      op::submit([&](int v) { result = v; });
+    return result;
+  });
+})
+
+PUSHMI_BENCHMARK("get", [](pushmi_benchmarks::chronometer& meter){
+  meter.measure([&]{
+    return op::just(pushmi_benchmarks::opaque(1)) | op::get<int>;
+  });
+})
+
+PUSHMI_BENCHMARK("measure", [](pushmi_benchmarks::chronometer& meter){
+  mi::histogram h;
+  int result = 0;
+  meter.measure([&]{
+    op::just(pushmi_benchmarks::opaque(1)) |
+      op::measure(h) |
+      op::submit([&](int v) { result = v; });
+    return result;
+  });
+})
+
+PUSHMI_BENCHMARK("histogram record", [](pushmi_benchmarks::chronometer& meter){
+  mi::histogram h;
+  std::uint64_t ns = 0;
+  meter.measure([&]{
+    h.record(pushmi_benchmarks::opaque(++ns % 100000));
+  });
+})
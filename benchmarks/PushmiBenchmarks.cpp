@@ -1,3 +1,4 @@
+#include <vector>
 
 #include "pushmi/o/just.h"
 #include "pushmi/o/on.h"
@@ -10,6 +11,8 @@
 #include "pushmi/new_thread.h"
 
 #include "pool.h"
+#include "reduce.h"
+#include "naive_bulk_target.h"
 
 using namespace pushmi::aliases;
 
@@ -27,10 +30,9 @@ struct countdownsingle {
   }
 };
 
-#define concept Concept
-#include <nonius/nonius.h++>
+#include "benchmark.h"
 
-NONIUS_BENCHMARK("trampoline virtual derecursion 10,000", [](nonius::chronometer meter){
+PUSHMI_BENCHMARK("trampoline virtual derecursion 10,000", [](pushmi_benchmarks::chronometer& meter){
   int counter = 0;
   auto tr = mi::trampoline();
   using TR = decltype(tr);
@@ -46,7 +48,7 @@ NONIUS_BENCHMARK("trampoline virtual derecursion 10,000", [](nonius::chronometer
   });
 })
 
-NONIUS_BENCHMARK("trampoline static derecursion 10,000", [](nonius::chronometer meter){
+PUSHMI_BENCHMARK("trampoline static derecursion 10,000", [](pushmi_benchmarks::chronometer& meter){
   int counter = 0;
   auto tr = mi::trampoline();
   using TR = decltype(tr);
@@ -57,7 +59,7 @@ NONIUS_BENCHMARK("trampoline static derecursion 10,000", [](nonius::chronometer
   });
 })
 
-NONIUS_BENCHMARK("new thread 10 blocking_submits", [](nonius::chronometer meter){
+PUSHMI_BENCHMARK("new thread 10 blocking_submits", [](pushmi_benchmarks::chronometer& meter){
   auto nt = mi::new_thread();
   using NT = decltype(nt);
   meter.measure([&]{
@@ -78,7 +80,7 @@ NONIUS_BENCHMARK("new thread 10 blocking_submits", [](nonius::chronometer meter)
   });
 })
 
-NONIUS_BENCHMARK("pool 10 blocking_submits", [](nonius::chronometer meter){
+PUSHMI_BENCHMARK("pool 10 blocking_submits", [](pushmi_benchmarks::chronometer& meter){
   mi::pool pl{std::max(1u,std::thread::hardware_concurrency())};
   auto pe = pl.executor();
   using PE = decltype(pe);
@@ -99,3 +101,43 @@ NONIUS_BENCHMARK("pool 10 blocking_submits", [](nonius::chronometer meter){
       op::get<std::chrono::system_clock::time_point>;
   });
 })
+
+PUSHMI_BENCHMARK("pool naive reduce 10,000,000", [](pushmi_benchmarks::chronometer& meter){
+  mi::pool pl{std::max(1u,std::thread::hardware_concurrency())};
+  std::vector<int> vec(10'000'000, 4);
+  meter.measure([&]{
+    return mi::reduce(
+      mi::naive_executor_bulk_target(pl.executor()),
+      vec.begin(), vec.end(), 2, std::plus<>{});
+  });
+})
+
+PUSHMI_BENCHMARK("pool chunked reduce 10,000,000", [](pushmi_benchmarks::chronometer& meter){
+  mi::pool pl{std::max(1u,std::thread::hardware_concurrency())};
+  std::vector<int> vec(10'000'000, 4);
+  meter.measure([&]{
+    return mi::reduce(
+      mi::chunked_bulk_target(pl.executor(), [](){ return 0; }, std::plus<>{}),
+      vec.begin(), vec.end(), 2, std::plus<>{});
+  });
+})
+
+PUSHMI_BENCHMARK("pool tree reduce double 10,000,000", [](pushmi_benchmarks::chronometer& meter){
+  mi::pool pl{std::max(1u,std::thread::hardware_concurrency())};
+  std::vector<double> vec(10'000'000, 0.5);
+  meter.measure([&]{
+    return mi::reduce(
+      mi::chunked_target(pl.executor()),
+      vec.begin(), vec.end(), 2.0, [](double acc, double v){ return acc + v; });
+  });
+})
+
+PUSHMI_BENCHMARK("pool simd tree reduce double 10,000,000", [](pushmi_benchmarks::chronometer& meter){
+  mi::pool pl{std::max(1u,std::thread::hardware_concurrency())};
+  std::vector<double> vec(10'000'000, 0.5);
+  meter.measure([&]{
+    return mi::reduce(
+      mi::chunked_target(pl.executor()),
+      vec.begin(), vec.end(), 2.0, std::plus<>{});
+  });
+})
@@ -0,0 +1,168 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// a small benchmark runner that needs nothing beyond the standard library.
+// each benchmark gets a chronometer and calls measure() with the operation
+// to time, as with nonius. the runner reports the time and the number of
+// calls to the global operator new per operation, the allocations are
+// counted by the replacements of operator new in test/allocations.cpp, on
+// every thread.
+
+namespace pushmi_benchmarks {
+
+// the calls to the global operator new since the start of the program.
+std::uint64_t allocations() noexcept;
+
+// keeps the compiler from dropping the computation of v.
+template <class T>
+void keep(T const& v) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "g"(&v) : "memory");
+#else
+  static const void* volatile sink;
+  sink = &v;
+  (void)sink;
+#endif
+}
+
+// hides v from the optimizer, so a pipeline of inline operators is not
+// folded into a constant.
+template <class T>
+T opaque(T v) {
+  volatile T hidden = v;
+  return hidden;
+}
+
+struct result {
+  std::size_t iterations = 0;
+  double ns_per_op = 0;
+  double min_ns_per_op = 0;
+  double allocs_per_op = 0;
+};
+
+class chronometer {
+  using clock = std::chrono::steady_clock;
+
+  template <class F>
+  static void run(F& f, std::true_type) {
+    f();
+  }
+  template <class F>
+  static void run(F& f, std::false_type) {
+    keep(f());
+  }
+
+  template <class F>
+  std::chrono::nanoseconds sample(F& f, std::size_t iterations) {
+    using is_void = std::is_void<decltype(f())>;
+    const auto start = clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+      run(f, is_void{});
+    }
+    return clock::now() - start;
+  }
+
+  std::chrono::nanoseconds target_;
+  std::size_t samples_;
+  result result_;
+
+public:
+  chronometer(std::chrono::nanoseconds target, std::size_t samples)
+    : target_(target), samples_(samples) {}
+
+  // runs f in samples of as many iterations as fit in the target time,
+  // after one warm up sample.
+  template <class F>
+  void measure(F f) {
+    std::size_t iterations = 1;
+    for (;;) {
+      const auto elapsed = sample(f, iterations);
+      if (elapsed >= target_ || iterations >= (std::size_t(1) << 30)) {
+        break;
+      }
+      iterations = elapsed.count() <= 0
+        ? iterations * 2
+        : std::max(iterations * 2, std::size_t(
+            iterations * 1.2 * target_.count() / elapsed.count()));
+    }
+
+    double total = 0;
+    double fastest = 0;
+    const auto allocated = allocations();
+    for (std::size_t s = 0; s < samples_; ++s) {
+      const double ns = sample(f, iterations).count();
+      total += ns;
+      fastest = s == 0 ? ns : std::min(fastest, ns);
+    }
+    const double ops = double(iterations) * samples_;
+    result_.iterations = iterations;
+    result_.ns_per_op = total / ops;
+    result_.min_ns_per_op = fastest / iterations;
+    result_.allocs_per_op = (allocations() - allocated) / ops;
+  }
+
+  const result& get() const {
+    return result_;
+  }
+};
+
+struct benchmark {
+  std::string name;
+  std::function<void(chronometer&)> fn;
+};
+
+inline std::vector<benchmark>& registry() {
+  static std::vector<benchmark> benchmarks;
+  return benchmarks;
+}
+
+struct registrar {
+  registrar(std::string name, std::function<void(chronometer&)> fn) {
+    registry().push_back({std::move(name), std::move(fn)});
+  }
+};
+
+// runs the benchmarks whose name contains filter, in the order that they
+// were registered, and prints a line for each.
+inline int run(int argc, char** argv) {
+  const char* filter = argc > 1 ? argv[1] : "";
+  std::printf("%-48s %12s %12s %12s %10s\n",
+    "benchmark", "ns/op", "min ns/op", "allocs/op", "iters");
+  for (auto& b : registry()) {
+    if (b.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    chronometer meter{std::chrono::milliseconds(20), 10};
+    b.fn(meter);
+    auto& r = meter.get();
+    std::printf("%-48s %12.1f %12.1f %12.2f %10zu\n",
+      b.name.c_str(), r.ns_per_op, r.min_ns_per_op, r.allocs_per_op,
+      r.iterations);
+    std::fflush(stdout);
+  }
+  return 0;
+}
+
+} // namespace pushmi_benchmarks
+
+#define PUSHMI_BENCHMARK_CAT_(A, B) A ## B
+#define PUSHMI_BENCHMARK_CAT(A, B) PUSHMI_BENCHMARK_CAT_(A, B)
+
+// PUSHMI_BENCHMARK("name", [](pushmi_benchmarks::chronometer& meter){...})
+#define PUSHMI_BENCHMARK(NAME, ...)                                          \
+  static ::pushmi_benchmarks::registrar                                      \
+    PUSHMI_BENCHMARK_CAT(pushmi_benchmark_, __LINE__){NAME, __VA_ARGS__};
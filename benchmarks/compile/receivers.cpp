@@ -0,0 +1,48 @@
+// the overload sets of make_single and make_many with each combination of
+// signal functions. each N instantiates its own lambdas.
+
+#include <exception>
+#include <utility>
+
+#include "pushmi/many.h"
+#include "pushmi/single.h"
+
+using namespace pushmi::aliases;
+
+namespace {
+
+template <int N>
+int receivers() {
+  int result = 0;
+  auto value = [&](int v) { result += v + N; };
+  auto error = [&](std::exception_ptr) noexcept { result = -N; };
+  auto done = [&]() { result += N; };
+  auto s0 = mi::make_single(value);
+  auto s1 = mi::make_single(value, error);
+  auto s2 = mi::make_single(value, error, done);
+  auto s3 = mi::make_single(mi::on_done(done));
+  auto s4 = mi::make_single(s2, mi::on_value([](auto& out, int v) {
+    ::pushmi::set_value(out, v * N);
+  }));
+  auto m0 = mi::make_many(value, error, done);
+  ::pushmi::set_value(s0, 1);
+  ::pushmi::set_value(s1, 1);
+  ::pushmi::set_value(s2, 1);
+  ::pushmi::set_done(s3);
+  ::pushmi::set_value(s4, 1);
+  ::pushmi::set_value(m0, 1);
+  return result;
+}
+
+template <int... N>
+int all_receivers(std::integer_sequence<int, N...>) {
+  int sum = 0;
+  (void) std::initializer_list<int>{(sum += receivers<N>(), 0)...};
+  return sum;
+}
+
+} // namespace
+
+int compile_receivers() {
+  return all_receivers(std::make_integer_sequence<int, 32>{});
+}
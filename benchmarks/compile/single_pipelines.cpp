@@ -0,0 +1,39 @@
+// representative single sender pipelines. each N instantiates its own
+// lambdas, so the time is spent on pushmi and not on the code of one chain.
+
+#include <utility>
+
+#include "pushmi/o/filter.h"
+#include "pushmi/o/just.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/tap.h"
+#include "pushmi/o/transform.h"
+
+using namespace pushmi::aliases;
+
+namespace {
+
+template <int N>
+int single_pipeline() {
+  int result = 0;
+  op::just(N) |
+    op::transform([](int v) { return v + N; }) |
+    op::filter([](int v) { return v % 2 == N % 2; }) |
+    op::tap([](int) {}) |
+    op::transform([](int v) { return double(v) * N; }) |
+    op::submit([&](double v) { result = int(v); });
+  return result;
+}
+
+template <int... N>
+int single_pipelines(std::integer_sequence<int, N...>) {
+  int sum = 0;
+  (void) std::initializer_list<int>{(sum += single_pipeline<N>(), 0)...};
+  return sum;
+}
+
+} // namespace
+
+int compile_single_pipelines() {
+  return single_pipelines(std::make_integer_sequence<int, 32>{});
+}
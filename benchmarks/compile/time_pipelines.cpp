@@ -0,0 +1,38 @@
+// representative pipelines on time executors. each N instantiates its own
+// lambdas, so the time is spent on pushmi and not on the code of one chain.
+
+#include <utility>
+
+#include "pushmi/o/submit.h"
+#include "pushmi/o/transform.h"
+#include "pushmi/o/via.h"
+#include "pushmi/trampoline.h"
+
+using namespace pushmi::aliases;
+
+namespace {
+
+template <int N>
+int time_pipeline() {
+  int result = 0;
+  auto tr = mi::trampoline();
+  tr |
+    op::transform([](auto) { return N; }) |
+    op::via([] { return mi::trampoline(); }) |
+    op::transform([](int v) { return v * N; }) |
+    op::submit([&](int v) { result = v; });
+  return result;
+}
+
+template <int... N>
+int time_pipelines(std::integer_sequence<int, N...>) {
+  int sum = 0;
+  (void) std::initializer_list<int>{(sum += time_pipeline<N>(), 0)...};
+  return sum;
+}
+
+} // namespace
+
+int compile_time_pipelines() {
+  return time_pipelines(std::make_integer_sequence<int, 16>{});
+}
@@ -1,3 +1,13 @@
-#define NONIUS_RUNNER
-#define concept Concept
-#include <nonius/nonius.h++>
+#include "allocations.h"
+#include "benchmark.h"
+
+// the allocations are counted by the replacements of operator new that the
+// benchmarks share with the tests, in test/allocations.cpp.
+
+std::uint64_t pushmi_benchmarks::allocations() noexcept {
+  return pushmi_test::all_allocations();
+}
+
+int main(int argc, char** argv) {
+  return pushmi_benchmarks::run(argc, argv);
+}
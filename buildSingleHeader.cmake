@@ -18,6 +18,27 @@ function(BuildSingleHeader HeaderName)
     file(WRITE ${CMAKE_CURRENT_SOURCE_DIR}/include/${HeaderName}.h "${incls}")
 endfunction()
 
+# writes a `pushmi` C++20 named module interface from the same headers. the
+# system includes of the single-header go into the global module fragment
+# and every declaration of the library is exported. macros are not exported
+# from a named module, code that uses PUSHMI_TEMPLATE and friends still
+# includes the headers.
+function(BuildModuleInterface ModuleName)
+    set(header_files ${ARGN})
+    file(READ "${CMAKE_CURRENT_SOURCE_DIR}/include/${ModuleName}-single-header.h" header)
+    string(REGEX REPLACE "[\t ]*#[\t ]*(pragma[\t ]+once|ifndef[\t ]+PUSHMI_SINGLE_HEADER|define[\t ]+PUSHMI_SINGLE_HEADER)[^\n]*\n" "" header "${header}")
+    set(module "module;\n${header}\nexport module ${ModuleName};\n\nexport {\n")
+
+    foreach(f ${header_files})
+        file(READ ${f} contents)
+        string(REGEX REPLACE "(([\t ]*#[\t ]*pragma[\t ]+once)|([\t ]*#[\t ]*include))" "//\\1" filtered "${contents}")
+        string(APPEND module "${filtered}")
+    endforeach()
+
+    string(APPEND module "\n} // export\n")
+    file(WRITE ${CMAKE_CURRENT_SOURCE_DIR}/include/${ModuleName}.cppm "${module}")
+endfunction()
+
 set(header_files
     # keep in inclusion order
 
@@ -26,6 +47,9 @@ set(header_files
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/traits.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/detail/functional.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/detail/opt.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/detail/block_cache.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/detail/heap_fallback.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/stop_token.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/forwards.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/extension_points.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/properties.h"
@@ -36,25 +60,43 @@ set(header_files
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/deferred.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/single.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/single_deferred.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/many.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/time_single_deferred.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/executor.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/flow_single.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/flow_single_deferred.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/flow_many.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/flow_many_deferred.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/trampoline.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/new_thread.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/extension_operators.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/submit.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/subject.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/replay_subject.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/empty.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/just.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/defer.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/on.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/fusion.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/tap.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/transform.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/filter.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/via.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/request_via.h"
     "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/share.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/publish.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/flow_from.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/as_flow_many.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/bulk.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/when_all.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/when_any.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/timeout.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/retry.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/cache.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/single_flight.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/histogram.h"
+    "${CMAKE_CURRENT_SOURCE_DIR}/include/pushmi/o/measure.h"
 )
 
 BuildSingleHeader("pushmi" ${header_files})
+BuildModuleInterface("pushmi" ${header_files})
@@ -104,5 +104,16 @@ int main()
   ioPool.wait();
   cpuPool.wait();
 
+  auto stats = cpuPool.stats();
+  std::cout << "cpu pool: " << stats.completed << " tasks, queued p50 "
+            << stats.queued.value_at(0.5) << "ns p99 "
+            << stats.queued.value_at(0.99) << "ns, running p50 "
+            << stats.running.value_at(0.5) << "ns p99 "
+            << stats.running.value_at(0.99) << "ns" << std::endl;
+  for (auto& w : stats.workers) {
+    std::cout << "  worker: " << w.tasks << " tasks, "
+              << int(w.utilization() * 100) << "% busy" << std::endl;
+  }
+
   std::cout << "OK" << std::endl;
 }
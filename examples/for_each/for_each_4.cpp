@@ -0,0 +1,44 @@
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+#include <pool.h>
+#include <for_each.h>
+
+using namespace pushmi::aliases;
+
+template<class Executor, class Policy>
+void fill(Executor e, Policy policy) {
+  std::vector<int> vec(10);
+  mi::bulk_stats stats;
+
+  mi::for_each(
+    mi::chunked_bulk_target(e, [](){ return 0; }, [](int acc, int){ return acc; },
+      policy, 0, &stats),
+    vec.begin(), vec.end(), [](int& x){
+      x = 42;
+    });
+
+  assert(std::count(vec.begin(), vec.end(), 42) == static_cast<int>(vec.size()));
+
+  std::size_t iterations = 0;
+  for (auto& w : stats.workers) {
+    iterations += w.iterations;
+  }
+  assert(iterations == vec.size());
+}
+
+int main()
+{
+  mi::pool p{std::max(1u,std::thread::hardware_concurrency())};
+
+  fill(p.executor(), mi::auto_partition{});
+  fill(p.executor(), mi::static_chunk{3});
+  fill(p.executor(), mi::dynamic_chunk{2});
+  fill(p.executor(), mi::guided{});
+
+  std::cout << "OK" << std::endl;
+
+  p.wait();
+}
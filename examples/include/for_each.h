@@ -5,7 +5,7 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
-#include <bulk.h>
+#include <pushmi/o/bulk.h>
 #include <pushmi/o/submit.h>
 #include <pushmi/o/just.h>
 
@@ -0,0 +1,97 @@
+#pragma once
+
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <tuple>
+
+#include <pushmi/o/submit.h>
+
+namespace pushmi {
+
+// naive_executor_bulk_target submits one task per index and combines every
+// step into a single shared atomic accumulator. it is kept as the baseline
+// that chunked_bulk_target is measured against.
+template<class Executor, class Allocator = std::allocator<char>>
+auto naive_executor_bulk_target(Executor e, Allocator a = Allocator{}) {
+  return [e, a](
+      auto init,
+      auto selector,
+      auto input,
+      auto&& func,
+      auto sb,
+      auto se,
+      auto out) {
+        using RS = decltype(selector);
+        using F = std::conditional_t<
+          std::is_lvalue_reference<decltype(func)>::value,
+          decltype(func),
+          typename std::remove_reference<decltype(func)>::type>;
+        using Out = decltype(out);
+        try {
+          typename std::allocator_traits<Allocator>::template rebind_alloc<char> allocState(a);
+          auto shared_state = std::allocate_shared<
+            std::tuple<
+              std::exception_ptr, // first exception
+              Out, // destination
+              RS, // selector
+              F, // func
+              std::atomic<decltype(init(input))>, // accumulation
+              std::atomic<std::size_t>, // pending
+              std::atomic<std::size_t> // exception count (protects assignment to first exception)
+            >>(allocState, std::exception_ptr{}, std::move(out), std::move(selector), (decltype(func) &&) func, init(std::move(input)), 1, 0);
+          e | operators::submit([e, sb, se, shared_state](auto ){
+            auto stepDone = [](auto shared_state){
+              // pending
+              if (--std::get<5>(*shared_state) == 0) {
+                // first exception
+                if (std::get<0>(*shared_state)) {
+                  ::pushmi::set_error(std::get<1>(*shared_state), std::get<0>(*shared_state));
+                  return;
+                }
+                try {
+                  // selector(accumulation)
+                  auto result = std::get<2>(*shared_state)(std::move(std::get<4>(*shared_state).load()));
+                  ::pushmi::set_value(std::get<1>(*shared_state), std::move(result));
+                } catch(...) {
+                  ::pushmi::set_error(std::get<1>(*shared_state), std::current_exception());
+                }
+              }
+            };
+            for (decltype(sb) idx{sb}; idx != se; ++idx, ++std::get<5>(*shared_state)){
+                e | operators::submit([shared_state, idx, stepDone](auto ex){
+                  try {
+                    // this indicates to me that bulk is not the right abstraction
+                    auto old = std::get<4>(*shared_state).load();
+                    auto step = old;
+                    do {
+                      step = old;
+                      // func(accumulation, idx)
+                      std::get<3>(*shared_state)(step, idx);
+                    } while(!std::get<4>(*shared_state).compare_exchange_strong(old, step));
+                  } catch(...) {
+                    // exception count
+                    if (std::get<6>(*shared_state)++ == 0) {
+                      // store first exception
+                      std::get<0>(*shared_state) = std::current_exception();
+                    } // else eat the exception
+                  }
+                  stepDone(shared_state);
+                });
+            }
+            stepDone(shared_state);
+          });
+        } catch(...) {
+          e | operators::submit([out = std::move(out), ep = std::current_exception()]() mutable {
+            ::pushmi::set_error(out, ep);
+          });
+        }
+    };
+}
+
+} // namespace pushmi
@@ -5,9 +5,19 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <experimental/thread_pool>
 
 #include <pushmi/executor.h>
+#include <pushmi/histogram.h>
 #include <pushmi/trampoline.h>
 
 #if __cpp_deduction_guides >= 201703
@@ -22,32 +32,183 @@ namespace pushmi {
 using std::experimental::static_thread_pool;
 namespace execution = std::experimental::execution;
 
+// the time that one worker of a pool has spent running tasks, since the
+// pool was created.
+struct pool_worker_stats {
+  std::uint64_t tasks = 0;
+  std::chrono::nanoseconds busy{0};
+  std::chrono::nanoseconds idle{0};
+  double utilization() const {
+    const auto total = (busy + idle).count();
+    return total == 0 ? 0.0 : double(busy.count()) / total;
+  }
+};
+
+// a snapshot of the metrics of a pool. the histograms are in nanoseconds,
+// except depth, that is the number of tasks that each submit found queued
+// ahead of it. the difference between queued and running tells whether a
+// slow task waited for a worker or took long to run.
+struct pool_stats {
+  std::uint64_t submitted = 0;
+  std::uint64_t completed = 0;
+  std::uint64_t cancelled = 0; // stopped while queued, never ran
+  histogram_snapshot queued; // from submit to the start of the task
+  histogram_snapshot running; // from the start to the end of the task
+  histogram_snapshot depth;
+  std::vector<pool_worker_stats> workers;
+};
+
+// the metrics that the tasks of a pool record as they run. a worker is
+// given a slot the first time that it runs a task of the pool.
+class __pool_metrics {
+  using clock = std::chrono::steady_clock;
+  struct worker {
+    std::atomic<std::uint64_t> tasks{0};
+    std::atomic<std::uint64_t> busy{0};
+  };
+
+  const clock::time_point created_ = clock::now();
+  std::atomic<std::uint64_t> submitted_{0};
+  std::atomic<std::uint64_t> completed_{0};
+  std::atomic<std::uint64_t> cancelled_{0};
+  std::atomic<std::int64_t> queued_now_{0};
+  histogram queued_;
+  histogram running_;
+  histogram depth_;
+  std::unique_ptr<worker[]> workers_;
+  const std::size_t threads_;
+  std::mutex lock_;
+  std::vector<std::thread::id> ids_;
+
+  worker& this_worker() {
+    struct cached {
+      const __pool_metrics* metrics;
+      worker* w;
+    };
+    static thread_local cached c{nullptr, nullptr};
+    if (c.metrics != this) {
+      std::unique_lock<std::mutex> guard{lock_};
+      const auto id = std::this_thread::get_id();
+      std::size_t slot = 0;
+      while (slot < ids_.size() && ids_[slot] != id) {
+        ++slot;
+      }
+      if (slot == ids_.size() && ids_.size() < threads_) {
+        ids_.push_back(id);
+      }
+      c = cached{this, &workers_[std::min(slot, threads_ - 1)]};
+    }
+    return *c.w;
+  }
+
+  static std::uint64_t ns(clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+  }
+
+public:
+  explicit __pool_metrics(std::size_t threads)
+    : workers_(new worker[std::max<std::size_t>(threads, 1)]),
+      threads_(std::max<std::size_t>(threads, 1)) {}
+
+  // called by submit, returns the time that the task was queued at.
+  clock::time_point queue() {
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    depth_.record(std::uint64_t(
+      queued_now_.fetch_add(1, std::memory_order_relaxed)));
+    return clock::now();
+  }
+  // called when the task starts, returns the time that it started at.
+  clock::time_point start(clock::time_point queued) {
+    queued_now_.fetch_sub(1, std::memory_order_relaxed);
+    const auto now = clock::now();
+    queued_.record(now - queued);
+    return now;
+  }
+  void cancel() {
+    cancelled_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void complete(clock::time_point started) {
+    const auto d = clock::now() - started;
+    running_.record(d);
+    auto& w = this_worker();
+    w.tasks.fetch_add(1, std::memory_order_relaxed);
+    w.busy.fetch_add(ns(d), std::memory_order_relaxed);
+    completed_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  pool_stats stats() const {
+    pool_stats s;
+    s.submitted = submitted_.load(std::memory_order_relaxed);
+    s.completed = completed_.load(std::memory_order_relaxed);
+    s.cancelled = cancelled_.load(std::memory_order_relaxed);
+    s.queued = queued_.snapshot();
+    s.running = running_.snapshot();
+    s.depth = depth_.snapshot();
+    const auto alive = ns(clock::now() - created_);
+    for (std::size_t i = 0; i < threads_; ++i) {
+      pool_worker_stats w;
+      w.tasks = workers_[i].tasks.load(std::memory_order_relaxed);
+      const auto busy = std::min(
+        workers_[i].busy.load(std::memory_order_relaxed), alive);
+      w.busy = std::chrono::nanoseconds(busy);
+      w.idle = std::chrono::nanoseconds(alive - busy);
+      s.workers.push_back(w);
+    }
+    return s;
+  }
+};
+
 template<class Executor>
 struct __pool_submit {
   using e_t = Executor;
   e_t e;
-  explicit __pool_submit(e_t e) : e(std::move(e)) {}
+  __pool_metrics* m;
+  __pool_submit(e_t e, __pool_metrics* m) : e(std::move(e)), m(m) {}
+  bool is_current() const {
+    return e.running_in_this_thread();
+  }
   PUSHMI_TEMPLATE(class TP, class Out)
     (requires Regular<TP> && Receiver<Out>)
   void operator()(TP at, Out out) const {
-    e.execute([e = this->e, at = std::move(at), out = std::move(out)]() mutable {
+    auto m = this->m;
+    auto queued = m->queue();
+    e.execute([e = this->e, m, queued, at = std::move(at), out = std::move(out)]() mutable {
+      auto started = m->start(queued);
+      // a request that was cancelled while queued does not use pool time
+      if (::pushmi::get_stop_token(out).stop_requested()) {
+        m->cancel();
+        ::pushmi::set_done(out);
+        return;
+      }
       auto tr = trampoline();
-      ::pushmi::submit(tr, std::move(at), std::move(out));
+      // poor mans scope guard, a task that throws has run all the same
+      try {
+        ::pushmi::submit(tr, std::move(at), std::move(out));
+      } catch(...) {
+        m->complete(started);
+        throw;
+      }
+      m->complete(started);
     });
   }
 };
 
 class pool {
+  std::unique_ptr<__pool_metrics> m;
   static_thread_pool p;
 public:
 
-  inline explicit pool(std::size_t threads) : p(threads) {}
+  inline explicit pool(std::size_t threads)
+    : m(new __pool_metrics(threads)), p(threads) {}
 
   inline auto executor() {
     auto exec = execution::require(p.executor(), execution::never_blocking, execution::oneway);
-    return MAKE(time_single_deferred)(__pool_submit<decltype(exec)>{exec});
+    return MAKE(time_single_deferred)(__pool_submit<decltype(exec)>{exec, m.get()});
   }
 
+  // the metrics of every task that the executors of this pool have run.
+  inline pool_stats stats() const {return m->stats();}
+
   inline void stop() {p.stop();}
   inline void wait() {p.wait();}
 };
@@ -5,28 +5,251 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
-#include <bulk.h>
+#include <atomic>
+#include <memory>
+
+#include <pushmi/o/bulk.h>
 #include <pushmi/o/submit.h>
 #include <pushmi/o/just.h>
 
+#include <simd_reduce.h>
+
 namespace pushmi {
 
 template<class ExecutionPolicy, class ForwardIt, class T, class BinaryOp>
 T reduce(
   ExecutionPolicy&& policy,
-  ForwardIt begin, 
-  ForwardIt end, 
-  T init, 
+  ForwardIt begin,
+  ForwardIt end,
+  T init,
   BinaryOp binary_op){
-    return operators::just(std::move(init)) | 
+    return operators::just(std::move(init)) |
       operators::bulk(
-        [binary_op](auto& acc, auto cursor){ acc = binary_op(acc, *cursor); }, 
+        [binary_op](auto& acc, auto cursor){ acc = binary_op(acc, *cursor); },
         begin,
-        end, 
-        policy, 
-        [](auto&& args){ return args; }, 
+        end,
+        policy,
+        [](auto&& args){ return args; },
         [](auto&& acc){ return acc; }) |
       operators::get<T>;
     }
 
+namespace detail {
+
+// each chunk produces one partial result. partials are combined pairwise up
+// a binary tree: the second of two siblings to finish combines them, on
+// whichever executor thread it is running on. the root delivers an opt<T>
+// that is empty when the range was empty. out_ is moved from last, so that a
+// state that cannot be built leaves out to the caller.
+template<class T, class RandomIt, class LeafF, class CombineF, class Out>
+struct tree_reduce_state {
+  tree_reduce_state(
+    RandomIt begin, bulk_chunks chunks, LeafF leaf, CombineF combine, Out&& out)
+    : begin_(begin), chunks_(chunks), leaf_(std::move(leaf)),
+      combine_(std::move(combine)), partials_(chunks.count),
+      arrived_(new std::atomic<bool>[nodes(chunks.count)]()),
+      out_(std::move(out)) {}
+
+  // one arrival flag per pair at every level of the tree, about 2*count.
+  static std::size_t nodes(std::size_t count) {
+    std::size_t result = 0;
+    for (std::size_t width = count; width > 1; width = (width + 1) / 2) {
+      result += (width + 1) / 2;
+    }
+    return result;
+  }
+
+  RandomIt begin_;
+  bulk_chunks chunks_;
+  LeafF leaf_;
+  CombineF combine_;
+  padded_slots<T> partials_;
+  std::unique_ptr<std::atomic<bool>[]> arrived_;
+  std::atomic<std::size_t> exceptions_{0};
+  std::exception_ptr first_exception_;
+  Out out_;
+
+  void fail() noexcept {
+    if (exceptions_++ == 0) {
+      first_exception_ = std::current_exception();
+    }
+  }
+  void run(std::size_t c) {
+    try {
+      partials_[c] =
+        leaf_(begin_ + chunks_.first(c), begin_ + chunks_.last(c));
+    } catch (...) {
+      fail();
+    }
+    arrive(c);
+  }
+  void arrive(std::size_t c) {
+    std::size_t node = c;
+    std::size_t width = chunks_.count;
+    std::size_t level = 0;
+    std::size_t offset = 0;
+    while (width > 1) {
+      if ((node ^ 1) < width) {
+        if (!arrived_[offset + (node >> 1)].exchange(true)) {
+          // the sibling has not finished yet, it will do the combine.
+          return;
+        }
+        if (exceptions_ == 0) {
+          auto& left = partials_[(node & ~std::size_t{1}) << level];
+          auto& right = partials_[(node | 1) << level];
+          try {
+            left = combine_(std::move(*left), std::move(*right));
+          } catch (...) {
+            fail();
+          }
+        }
+      }
+      offset += (width + 1) / 2;
+      width = (width + 1) / 2;
+      node >>= 1;
+      ++level;
+    }
+    if (first_exception_) {
+      ::pushmi::set_error(out_, first_exception_);
+      return;
+    }
+    ::pushmi::set_value(out_, std::move(partials_[0]));
+  }
+};
+
+template<class T, class Executor, class RandomIt, class LeafF, class CombineF>
+auto tree_reduce(
+  const chunked_target_t<Executor>& target,
+  RandomIt begin,
+  RandomIt end,
+  LeafF leaf,
+  CombineF combine) {
+    const bulk_chunks chunks{
+      static_cast<std::size_t>(end - begin), target.workers, target.grain};
+    return make_single_deferred(
+      [e = target.e, begin, chunks, leaf, combine](auto out) mutable {
+        using State = tree_reduce_state<T, RandomIt, LeafF, CombineF, decltype(out)>;
+        if (chunks.count == 0) {
+          ::pushmi::set_value(out, opt<T>{});
+          return;
+        }
+        std::shared_ptr<State> state;
+        try {
+          state = std::make_shared<State>(begin, chunks, leaf, combine, std::move(out));
+        } catch (...) {
+          ::pushmi::set_error(out, std::current_exception());
+          return;
+        }
+        std::size_t c = 0;
+        try {
+          for (; c < chunks.count; ++c) {
+            e | operators::submit([state, c](auto) { state->run(c); });
+          }
+        } catch (...) {
+          // the chunks that were not submitted arrive without running, so
+          // the error is delivered once the submitted chunks have finished
+          // with the range.
+          state->fail();
+          for (; c < chunks.count; ++c) {
+            state->arrive(c);
+          }
+        }
+      }
+    ) | operators::get<opt<T>>;
+}
+
+template<class T, class RandomIt, class BinaryOp>
+auto reduce_leaf(BinaryOp binary_op, std::false_type) {
+  return [binary_op](RandomIt first, RandomIt last) {
+    T acc = *first;
+    for (++first; first != last; ++first) {
+      acc = binary_op(std::move(acc), *first);
+    }
+    return acc;
+  };
+}
+
+// contiguous float, double, int32_t and int64_t ranges reduced with
+// std::plus, minimum or maximum use the simd kernel for the running cpu.
+template<class T, class RandomIt, class BinaryOp>
+auto reduce_leaf(BinaryOp binary_op, std::true_type) {
+  return [binary_op](RandomIt first, RandomIt last) -> T {
+    return simd_reduce(std::addressof(*first),
+      static_cast<std::size_t>(last - first), binary_op);
+  };
+}
+
+} // namespace detail
+
+// with a chunked_target policy, reduce and transform_reduce run one task per
+// chunk on the executor, with no shared accumulator. T only needs to be move
+// constructible.
+
+template<class Executor, class RandomIt, class T, class BinaryOp, class UnaryOp>
+T transform_reduce(
+  const detail::chunked_target_t<Executor>& policy,
+  RandomIt begin,
+  RandomIt end,
+  T init,
+  BinaryOp binary_op,
+  UnaryOp unary_op){
+    auto total = detail::tree_reduce<T>(policy, begin, end,
+      [binary_op, unary_op](RandomIt first, RandomIt last) {
+        T acc = unary_op(*first);
+        for (++first; first != last; ++first) {
+          acc = binary_op(std::move(acc), unary_op(*first));
+        }
+        return acc;
+      },
+      binary_op);
+    if (!total) {
+      return init;
+    }
+    return binary_op(std::move(init), std::move(*total));
+  }
+
+template<class Executor, class RandomIt, class T, class BinaryOp>
+T reduce(
+  detail::chunked_target_t<Executor> policy,
+  RandomIt begin,
+  RandomIt end,
+  T init,
+  BinaryOp binary_op){
+    auto total = detail::tree_reduce<T>(policy, begin, end,
+      detail::reduce_leaf<T, RandomIt>(binary_op,
+        detail::is_simd_reducible<RandomIt, T, BinaryOp>{}),
+      binary_op);
+    if (!total) {
+      return init;
+    }
+    return binary_op(std::move(init), std::move(*total));
+  }
+
+// reduce with an identity folds each element into a chunk partial that
+// starts from identity() using accumulate(T, element), and combines partials
+// with combine(T, T). the element type does not need to convert to T.
+template<class Executor, class RandomIt, class T, class IdentityF, class AccumulateOp, class CombineOp>
+T reduce(
+  const detail::chunked_target_t<Executor>& policy,
+  RandomIt begin,
+  RandomIt end,
+  T init,
+  IdentityF identity,
+  AccumulateOp accumulate,
+  CombineOp combine){
+    auto total = detail::tree_reduce<T>(policy, begin, end,
+      [identity, accumulate](RandomIt first, RandomIt last) {
+        T acc = identity();
+        for (; first != last; ++first) {
+          acc = accumulate(std::move(acc), *first);
+        }
+        return acc;
+      },
+      combine);
+    if (!total) {
+      return init;
+    }
+    return combine(std::move(init), std::move(*total));
+  }
+
 } // namespace pushmi
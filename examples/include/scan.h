@@ -0,0 +1,341 @@
+#pragma once
+
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <pushmi/o/bulk.h>
+#include <pushmi/o/submit.h>
+
+namespace pushmi {
+
+namespace detail {
+
+// the scans and compactions below run in two passes over the same chunks:
+// pass one reduces each chunk to a summary (a sum or a count), the summaries
+// are scanned serially (there is one per chunk), and pass two applies the
+// scanned summary to each chunk. the states take out last, so that a state
+// that cannot be built leaves out to the caller to complete.
+
+template<class It, class OutIt, class T, class Op, class Out>
+struct scan_state {
+  scan_state(It first, OutIt d_first, bulk_chunks chunks, opt<T> init, Op op, Out&& out)
+    : first_(first), d_first_(d_first), chunks_(chunks), init_(std::move(init)),
+      op_(std::move(op)), sums_(chunks.count), carries_(chunks.count),
+      out_(std::move(out)) {}
+
+  It first_;
+  OutIt d_first_;
+  bulk_chunks chunks_;
+  opt<T> init_;
+  Op op_;
+  padded_slots<T> sums_;
+  std::vector<opt<T>> carries_;
+  Out out_;
+
+  void sum(std::size_t c) {
+    auto it = first_ + chunks_.first(c);
+    auto end = first_ + chunks_.last(c);
+    T acc = *it;
+    for (++it; it != end; ++it) {
+      acc = op_(std::move(acc), *it);
+    }
+    sums_[c] = std::move(acc);
+  }
+  void carry() {
+    opt<T> carry = std::move(init_);
+    for (std::size_t c = 0; c < chunks_.count; ++c) {
+      if (carry) {
+        carries_[c] = T(*carry);
+        carry = op_(std::move(*carry), std::move(*sums_[c]));
+      } else {
+        carry = std::move(*sums_[c]);
+      }
+    }
+  }
+  void inclusive(std::size_t c) {
+    auto it = first_ + chunks_.first(c);
+    auto end = first_ + chunks_.last(c);
+    auto out = d_first_ + chunks_.first(c);
+    opt<T> acc = std::move(carries_[c]);
+    for (; it != end; ++it, ++out) {
+      if (acc) {
+        acc = op_(std::move(*acc), *it);
+      } else {
+        acc = T(*it);
+      }
+      *out = *acc;
+    }
+  }
+  void exclusive(std::size_t c) {
+    auto it = first_ + chunks_.first(c);
+    auto end = first_ + chunks_.last(c);
+    auto out = d_first_ + chunks_.first(c);
+    T acc = std::move(*carries_[c]);
+    for (; it != end; ++it, ++out) {
+      T next = op_(acc, *it);
+      *out = std::move(acc);
+      acc = std::move(next);
+    }
+  }
+};
+
+template<class Executor, class It, class OutIt, class T, class Op>
+auto scan(
+  const chunked_target_t<Executor>& policy,
+  It first,
+  It last,
+  OutIt d_first,
+  opt<T> init,
+  Op op) {
+    const bulk_chunks chunks{
+      static_cast<std::size_t>(last - first), policy.workers, policy.grain};
+    const bool exclusive = !!init;
+    return make_single_deferred(
+      [e = policy.e, first, d_first, chunks, init = std::move(init), op, exclusive](auto out) mutable {
+        using State = scan_state<It, OutIt, T, Op, decltype(out)>;
+        std::shared_ptr<State> s;
+        try {
+          s = std::make_shared<State>(first, d_first, chunks, std::move(init), op, std::move(out));
+        } catch (...) {
+          ::pushmi::set_error(out, std::current_exception());
+          return;
+        }
+        parallel_chunks(e, chunks.count,
+          [s](std::size_t c) { s->sum(c); },
+          [e, s, exclusive](std::exception_ptr ep) mutable {
+            if (ep) {
+              ::pushmi::set_error(s->out_, ep);
+              return;
+            }
+            try {
+              s->carry();
+            } catch (...) {
+              ::pushmi::set_error(s->out_, std::current_exception());
+              return;
+            }
+            parallel_chunks(e, s->chunks_.count,
+              [s, exclusive](std::size_t c) {
+                if (exclusive) {
+                  s->exclusive(c);
+                } else {
+                  s->inclusive(c);
+                }
+              },
+              [s](std::exception_ptr ep) {
+                if (ep) {
+                  ::pushmi::set_error(s->out_, ep);
+                  return;
+                }
+                ::pushmi::set_value(s->out_, s->d_first_ + s->chunks_.size);
+              });
+          });
+      });
+}
+
+// copy_if and partition count the matches in each chunk in pass one and
+// write each chunk to its scanned offset in pass two.
+template<class It, class OutIt, class Pred, class Out>
+struct compact_state {
+  compact_state(It first, OutIt d_first, bulk_chunks chunks, Pred pred, Out&& out)
+    : first_(first), d_first_(d_first), chunks_(chunks), pred_(std::move(pred)),
+      counts_(chunks.count), offsets_(chunks.count), out_(std::move(out)) {}
+
+  It first_;
+  OutIt d_first_;
+  bulk_chunks chunks_;
+  Pred pred_;
+  padded_slots<std::size_t> counts_;
+  std::vector<std::size_t> offsets_;
+  std::size_t total_ = 0;
+  Out out_;
+
+  void count(std::size_t c) {
+    std::size_t n = 0;
+    for (auto it = first_ + chunks_.first(c), end = first_ + chunks_.last(c);
+        it != end; ++it) {
+      n += pred_(*it) ? 1 : 0;
+    }
+    counts_[c] = std::move(n);
+  }
+  void offsets() {
+    for (std::size_t c = 0; c < chunks_.count; ++c) {
+      offsets_[c] = total_;
+      total_ += *counts_[c];
+    }
+  }
+  void copy(std::size_t c) {
+    auto out = d_first_ + offsets_[c];
+    for (auto it = first_ + chunks_.first(c), end = first_ + chunks_.last(c);
+        it != end; ++it) {
+      if (pred_(*it)) {
+        *out = *it;
+        ++out;
+      }
+    }
+  }
+};
+
+template<class It, class Pred, class Out>
+struct partition_state : compact_state<It, It, Pred, Out> {
+  using value_type = typename std::iterator_traits<It>::value_type;
+  using compact_state<It, It, Pred, Out>::compact_state;
+
+  std::unique_ptr<opt<value_type>[]> buffer_;
+
+  void move_out(std::size_t c) {
+    std::size_t t = this->offsets_[c];
+    // the items before this chunk that did not match go after every match
+    std::size_t f = this->total_ + (this->chunks_.first(c) - t);
+    for (auto it = this->first_ + this->chunks_.first(c),
+        end = this->first_ + this->chunks_.last(c); it != end; ++it) {
+      if (this->pred_(*it)) {
+        buffer_[t++] = std::move(*it);
+      } else {
+        buffer_[f++] = std::move(*it);
+      }
+    }
+  }
+  void move_back(std::size_t c) {
+    for (std::size_t i = this->chunks_.first(c); i != this->chunks_.last(c); ++i) {
+      this->first_[i] = std::move(*buffer_[i]);
+    }
+  }
+};
+
+} // namespace detail
+
+// inclusive_scan(chunked_target(e), first, last, d_first, op) is a single
+// sender that writes the inclusive scan of [first, last) to d_first and
+// delivers the end of the output range.
+template<class Executor, class It, class OutIt, class BinaryOp = std::plus<>>
+auto inclusive_scan(
+  const detail::chunked_target_t<Executor>& policy,
+  It first,
+  It last,
+  OutIt d_first,
+  BinaryOp op = BinaryOp{}) {
+    using T = typename std::iterator_traits<It>::value_type;
+    return detail::scan(policy, first, last, d_first, detail::opt<T>{}, op);
+  }
+
+// exclusive_scan delivers the end of the output range once d_first holds
+// init, init op x0, ...
+template<class Executor, class It, class OutIt, class T, class BinaryOp = std::plus<>>
+auto exclusive_scan(
+  const detail::chunked_target_t<Executor>& policy,
+  It first,
+  It last,
+  OutIt d_first,
+  T init,
+  BinaryOp op = BinaryOp{}) {
+    detail::opt<T> carry;
+    carry = std::move(init);
+    return detail::scan(policy, first, last, d_first, std::move(carry), op);
+  }
+
+// copy_if delivers the end of the output range. the order of the copied items
+// is preserved.
+template<class Executor, class It, class OutIt, class Pred>
+auto copy_if(
+  const detail::chunked_target_t<Executor>& policy,
+  It first,
+  It last,
+  OutIt d_first,
+  Pred pred) {
+    const detail::bulk_chunks chunks{
+      static_cast<std::size_t>(last - first), policy.workers, policy.grain};
+    return make_single_deferred(
+      [e = policy.e, first, d_first, chunks, pred](auto out) mutable {
+        using State = detail::compact_state<It, OutIt, Pred, decltype(out)>;
+        std::shared_ptr<State> s;
+        try {
+          s = std::make_shared<State>(first, d_first, chunks, pred, std::move(out));
+        } catch (...) {
+          ::pushmi::set_error(out, std::current_exception());
+          return;
+        }
+        detail::parallel_chunks(e, chunks.count,
+          [s](std::size_t c) { s->count(c); },
+          [e, s](std::exception_ptr ep) mutable {
+            if (ep) {
+              ::pushmi::set_error(s->out_, ep);
+              return;
+            }
+            s->offsets();
+            detail::parallel_chunks(e, s->chunks_.count,
+              [s](std::size_t c) { s->copy(c); },
+              [s](std::exception_ptr ep) {
+                if (ep) {
+                  ::pushmi::set_error(s->out_, ep);
+                  return;
+                }
+                ::pushmi::set_value(s->out_, s->d_first_ + s->total_);
+              });
+          });
+      });
+  }
+
+// partition reorders [first, last) so that the items matching pred come
+// first, and delivers the partition point. both halves keep their relative
+// order. the items are moved through a temporary buffer.
+template<class Executor, class It, class Pred>
+auto partition(
+  const detail::chunked_target_t<Executor>& policy,
+  It first,
+  It last,
+  Pred pred) {
+    const detail::bulk_chunks chunks{
+      static_cast<std::size_t>(last - first), policy.workers, policy.grain};
+    return make_single_deferred(
+      [e = policy.e, first, chunks, pred](auto out) mutable {
+        using State = detail::partition_state<It, Pred, decltype(out)>;
+        using value_type = typename State::value_type;
+        std::shared_ptr<State> s;
+        try {
+          s = std::make_shared<State>(first, first, chunks, pred, std::move(out));
+        } catch (...) {
+          ::pushmi::set_error(out, std::current_exception());
+          return;
+        }
+        auto fail = [s](std::exception_ptr ep) {
+          ::pushmi::set_error(s->out_, ep);
+        };
+        detail::parallel_chunks(e, chunks.count,
+          [s](std::size_t c) { s->count(c); },
+          [e, s, fail](std::exception_ptr ep) mutable {
+            if (ep) {
+              return fail(ep);
+            }
+            s->offsets();
+            try {
+              s->buffer_.reset(new detail::opt<value_type>[s->chunks_.size]);
+            } catch (...) {
+              return fail(std::current_exception());
+            }
+            detail::parallel_chunks(e, s->chunks_.count,
+              [s](std::size_t c) { s->move_out(c); },
+              [e, s, fail](std::exception_ptr ep) mutable {
+                if (ep) {
+                  return fail(ep);
+                }
+                detail::parallel_chunks(e, s->chunks_.count,
+                  [s](std::size_t c) { s->move_back(c); },
+                  [s, fail](std::exception_ptr ep) {
+                    if (ep) {
+                      return fail(ep);
+                    }
+                    s->buffer_.reset();
+                    ::pushmi::set_value(s->out_, s->first_ + s->total_);
+                  });
+              });
+          });
+      });
+  }
+
+} // namespace pushmi
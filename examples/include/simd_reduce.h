@@ -0,0 +1,369 @@
+#pragma once
+
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PUSHMI_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define PUSHMI_SIMD_X86 0
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define PUSHMI_SIMD_TARGET(ISA)
+#else
+#define PUSHMI_SIMD_TARGET(ISA) __attribute__((target(ISA)))
+#endif
+
+namespace pushmi {
+
+// the min and max reductions that the simd kernels recognize, alongside
+// std::plus. minimum(acc, x) keeps acc unless x is smaller, which is also
+// what the min instructions do when called with (x, acc).
+struct minimum {
+  template <class T>
+  constexpr T operator()(T l, T r) const {
+    return r < l ? r : l;
+  }
+};
+struct maximum {
+  template <class T>
+  constexpr T operator()(T l, T r) const {
+    return l < r ? r : l;
+  }
+};
+
+namespace detail {
+
+enum class simd_level { scalar, sse42, avx2, avx512 };
+
+struct simd_sum {};
+struct simd_min {};
+struct simd_max {};
+
+// the kernel for Op over items of type T. std::plus<U> for another U would
+// convert every item to U, so only std::plus<T> and std::plus<> are summed.
+template <class Op, class T>
+struct simd_op { using type = void; };
+template <class T>
+struct simd_op<std::plus<T>, T> { using type = simd_sum; };
+template <class T>
+struct simd_op<std::plus<>, T> { using type = simd_sum; };
+template <class T>
+struct simd_op<minimum, T> { using type = simd_min; };
+template <class T>
+struct simd_op<maximum, T> { using type = simd_max; };
+
+template <class T>
+struct is_simd_type
+  : std::integral_constant<bool,
+      std::is_same<T, float>::value || std::is_same<T, double>::value ||
+      std::is_same<T, std::int32_t>::value || std::is_same<T, std::int64_t>::value> {};
+
+// pointers and vector iterators are the contiguous iterators that can be
+// recognized before C++20.
+template <class It, class V = typename std::iterator_traits<It>::value_type>
+struct is_contiguous_iterator
+  : std::integral_constant<bool,
+      std::is_pointer<It>::value ||
+      std::is_same<It, typename std::vector<V>::iterator>::value ||
+      std::is_same<It, typename std::vector<V>::const_iterator>::value> {};
+
+// true when reduce(first, last, init, op) can use the simd kernels.
+template <class It, class T, class Op>
+struct is_simd_reducible
+  : std::integral_constant<bool,
+      is_contiguous_iterator<It>::value &&
+      std::is_same<typename std::iterator_traits<It>::value_type, T>::value &&
+      is_simd_type<T>::value &&
+      !std::is_void<typename simd_op<Op, T>::type>::value> {};
+
+template <class T>
+T simd_apply(simd_sum, T acc, T x) {
+  return acc + x;
+}
+template <class T>
+T simd_apply(simd_min, T acc, T x) {
+  return minimum{}(acc, x);
+}
+template <class T>
+T simd_apply(simd_max, T acc, T x) {
+  return maximum{}(acc, x);
+}
+
+// four independent accumulators, so that consecutive adds do not wait on
+// each other.
+template <class T, class Op>
+T reduce_scalar(const T* p, std::size_t n, Op op) {
+  if (n < 4) {
+    T acc = p[0];
+    for (std::size_t i = 1; i < n; ++i) {
+      acc = simd_apply(op, acc, p[i]);
+    }
+    return acc;
+  }
+  T a0 = p[0], a1 = p[1], a2 = p[2], a3 = p[3];
+  std::size_t i = 4;
+  for (; i + 4 <= n; i += 4) {
+    a0 = simd_apply(op, a0, p[i]);
+    a1 = simd_apply(op, a1, p[i + 1]);
+    a2 = simd_apply(op, a2, p[i + 2]);
+    a3 = simd_apply(op, a3, p[i + 3]);
+  }
+  a0 = simd_apply(op, simd_apply(op, a0, a1), simd_apply(op, a2, a3));
+  for (; i < n; ++i) {
+    a0 = simd_apply(op, a0, p[i]);
+  }
+  return a0;
+}
+
+#if PUSHMI_SIMD_X86
+
+inline void simd_cpuid(unsigned leaf, unsigned sub, unsigned (&r)[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int regs[4];
+  __cpuidex(regs, static_cast<int>(leaf), static_cast<int>(sub));
+  for (int i = 0; i < 4; ++i) {
+    r[i] = static_cast<unsigned>(regs[i]);
+  }
+#else
+  __cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+#endif
+}
+
+// the register state that the os saves on a context switch.
+inline std::uint64_t simd_xcr0() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  return _xgetbv(0);
+#else
+  unsigned lo, hi;
+  __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return (static_cast<std::uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+inline simd_level detect_simd_level() {
+  unsigned r[4];
+  simd_cpuid(0, 0, r);
+  const unsigned max_leaf = r[0];
+  simd_cpuid(1, 0, r);
+  if (!(r[2] & (1u << 20))) {
+    return simd_level::scalar;
+  }
+  const bool osxsave = r[2] & (1u << 27);
+  const bool avx = r[2] & (1u << 28);
+  if (!osxsave || !avx || max_leaf < 7) {
+    return simd_level::sse42;
+  }
+  const std::uint64_t xcr0 = simd_xcr0();
+  if ((xcr0 & 0x6) != 0x6) {
+    return simd_level::sse42;
+  }
+  simd_cpuid(7, 0, r);
+  if (!(r[1] & (1u << 5))) {
+    return simd_level::sse42;
+  }
+  if ((r[1] & (1u << 16)) && (xcr0 & 0xe6) == 0xe6) {
+    return simd_level::avx512;
+  }
+  return simd_level::avx2;
+}
+
+// each simd_vec<Level, T> wraps the load, store and the three reductions
+// for one register width. min and max take (acc, x) like minimum/maximum.
+template <simd_level Level, class T>
+struct simd_vec;
+
+#define PUSHMI_SIMD_VEC_FP(LEVEL, ISA, T, REG, W, LOAD, STORE, ADD, MIN, MAX) \
+  template <>                                                               \
+  struct simd_vec<simd_level::LEVEL, T> {                                   \
+    using value_type = T;                                                   \
+    using reg = REG;                                                        \
+    static constexpr std::size_t width = W;                                 \
+    PUSHMI_SIMD_TARGET(ISA) static reg load(const T* p) { return LOAD(p); } \
+    PUSHMI_SIMD_TARGET(ISA) static void store(T* p, reg v) { STORE(p, v); } \
+    PUSHMI_SIMD_TARGET(ISA) static reg apply(simd_sum, reg a, reg x) {      \
+      return ADD(a, x);                                                     \
+    }                                                                       \
+    PUSHMI_SIMD_TARGET(ISA) static reg apply(simd_min, reg a, reg x) {      \
+      return MIN(x, a);                                                     \
+    }                                                                       \
+    PUSHMI_SIMD_TARGET(ISA) static reg apply(simd_max, reg a, reg x) {      \
+      return MAX(x, a);                                                     \
+    }                                                                       \
+  }
+
+PUSHMI_SIMD_VEC_FP(sse42, "sse4.2", float, __m128, 4,
+  _mm_loadu_ps, _mm_storeu_ps, _mm_add_ps, _mm_min_ps, _mm_max_ps);
+PUSHMI_SIMD_VEC_FP(sse42, "sse4.2", double, __m128d, 2,
+  _mm_loadu_pd, _mm_storeu_pd, _mm_add_pd, _mm_min_pd, _mm_max_pd);
+PUSHMI_SIMD_VEC_FP(avx2, "avx2", float, __m256, 8,
+  _mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps, _mm256_min_ps, _mm256_max_ps);
+PUSHMI_SIMD_VEC_FP(avx2, "avx2", double, __m256d, 4,
+  _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, _mm256_min_pd, _mm256_max_pd);
+PUSHMI_SIMD_VEC_FP(avx512, "avx512f", float, __m512, 16,
+  _mm512_loadu_ps, _mm512_storeu_ps, _mm512_add_ps, _mm512_min_ps, _mm512_max_ps);
+PUSHMI_SIMD_VEC_FP(avx512, "avx512f", double, __m512d, 8,
+  _mm512_loadu_pd, _mm512_storeu_pd, _mm512_add_pd, _mm512_min_pd, _mm512_max_pd);
+
+#undef PUSHMI_SIMD_VEC_FP
+
+#define PUSHMI_SIMD_VEC_INT(LEVEL, ISA, T, REG, W, LOAD, STORE, ADD, MIN, MAX) \
+  template <>                                                                \
+  struct simd_vec<simd_level::LEVEL, T> {                                    \
+    using value_type = T;                                                    \
+    using reg = REG;                                                         \
+    static constexpr std::size_t width = W;                                  \
+    PUSHMI_SIMD_TARGET(ISA) static reg load(const T* p) {                    \
+      return LOAD(reinterpret_cast<const reg*>(p));                          \
+    }                                                                        \
+    PUSHMI_SIMD_TARGET(ISA) static void store(T* p, reg v) {                 \
+      STORE(reinterpret_cast<reg*>(p), v);                                   \
+    }                                                                        \
+    PUSHMI_SIMD_TARGET(ISA) static reg apply(simd_sum, reg a, reg x) {       \
+      return ADD(a, x);                                                      \
+    }                                                                        \
+    PUSHMI_SIMD_TARGET(ISA) static reg apply(simd_min, reg a, reg x) {       \
+      return MIN(a, x);                                                      \
+    }                                                                        \
+    PUSHMI_SIMD_TARGET(ISA) static reg apply(simd_max, reg a, reg x) {       \
+      return MAX(a, x);                                                      \
+    }                                                                        \
+  }
+
+// there is no 64 bit integer min or max before avx512, they are built from
+// a compare and a blend.
+PUSHMI_SIMD_TARGET("sse4.2") inline __m128i simd_min_epi64(__m128i a, __m128i b) {
+  return _mm_blendv_epi8(a, b, _mm_cmpgt_epi64(a, b));
+}
+PUSHMI_SIMD_TARGET("sse4.2") inline __m128i simd_max_epi64(__m128i a, __m128i b) {
+  return _mm_blendv_epi8(b, a, _mm_cmpgt_epi64(a, b));
+}
+PUSHMI_SIMD_TARGET("avx2") inline __m256i simd_min_epi64(__m256i a, __m256i b) {
+  return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+PUSHMI_SIMD_TARGET("avx2") inline __m256i simd_max_epi64(__m256i a, __m256i b) {
+  return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+}
+
+PUSHMI_SIMD_VEC_INT(sse42, "sse4.2", std::int32_t, __m128i, 4,
+  _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi32, _mm_min_epi32, _mm_max_epi32);
+PUSHMI_SIMD_VEC_INT(sse42, "sse4.2", std::int64_t, __m128i, 2,
+  _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi64, simd_min_epi64, simd_max_epi64);
+PUSHMI_SIMD_VEC_INT(avx2, "avx2", std::int32_t, __m256i, 8,
+  _mm256_loadu_si256, _mm256_storeu_si256, _mm256_add_epi32, _mm256_min_epi32, _mm256_max_epi32);
+PUSHMI_SIMD_VEC_INT(avx2, "avx2", std::int64_t, __m256i, 4,
+  _mm256_loadu_si256, _mm256_storeu_si256, _mm256_add_epi64, simd_min_epi64, simd_max_epi64);
+PUSHMI_SIMD_VEC_INT(avx512, "avx512f", std::int32_t, __m512i, 16,
+  _mm512_loadu_si512, _mm512_storeu_si512, _mm512_add_epi32, _mm512_min_epi32, _mm512_max_epi32);
+PUSHMI_SIMD_VEC_INT(avx512, "avx512f", std::int64_t, __m512i, 8,
+  _mm512_loadu_si512, _mm512_storeu_si512, _mm512_add_epi64, _mm512_min_epi64, _mm512_max_epi64);
+
+#undef PUSHMI_SIMD_VEC_INT
+
+// the kernel body is the same for every level, but each copy has to be
+// compiled for its own instruction set so that the simd_vec calls inline.
+// four registers are in flight per iteration, then folded into one, and the
+// lanes and the tail are finished with scalar code.
+#define PUSHMI_SIMD_REDUCE_KERNEL(NAME, ISA)                                  \
+  template <class V, class Op>                                               \
+  PUSHMI_SIMD_TARGET(ISA) typename V::value_type NAME(                       \
+      const typename V::value_type* p, std::size_t n, Op op) {               \
+    using T = typename V::value_type;                                        \
+    constexpr std::size_t w = V::width;                                      \
+    if (n < 4 * w) {                                                         \
+      return reduce_scalar(p, n, op);                                        \
+    }                                                                        \
+    auto a0 = V::load(p);                                                    \
+    auto a1 = V::load(p + w);                                                \
+    auto a2 = V::load(p + 2 * w);                                            \
+    auto a3 = V::load(p + 3 * w);                                            \
+    std::size_t i = 4 * w;                                                   \
+    for (; i + 4 * w <= n; i += 4 * w) {                                     \
+      a0 = V::apply(op, a0, V::load(p + i));                                 \
+      a1 = V::apply(op, a1, V::load(p + i + w));                             \
+      a2 = V::apply(op, a2, V::load(p + i + 2 * w));                         \
+      a3 = V::apply(op, a3, V::load(p + i + 3 * w));                         \
+    }                                                                        \
+    for (; i + w <= n; i += w) {                                             \
+      a0 = V::apply(op, a0, V::load(p + i));                                 \
+    }                                                                        \
+    a0 = V::apply(op, V::apply(op, a0, a1), V::apply(op, a2, a3));           \
+    T lanes[w];                                                              \
+    V::store(lanes, a0);                                                     \
+    T acc = lanes[0];                                                        \
+    for (std::size_t l = 1; l < w; ++l) {                                    \
+      acc = simd_apply(op, acc, lanes[l]);                                   \
+    }                                                                        \
+    for (; i < n; ++i) {                                                     \
+      acc = simd_apply(op, acc, p[i]);                                       \
+    }                                                                        \
+    return acc;                                                              \
+  }
+
+PUSHMI_SIMD_REDUCE_KERNEL(reduce_sse42, "sse4.2")
+PUSHMI_SIMD_REDUCE_KERNEL(reduce_avx2, "avx2")
+PUSHMI_SIMD_REDUCE_KERNEL(reduce_avx512, "avx512f")
+
+#undef PUSHMI_SIMD_REDUCE_KERNEL
+
+#else
+
+inline simd_level detect_simd_level() {
+  return simd_level::scalar;
+}
+
+#endif
+
+// the level of the running cpu, detected once.
+inline simd_level current_simd_level() {
+  static const simd_level level = detect_simd_level();
+  return level;
+}
+
+// reduces the n > 0 items at p with the kernel for level, which must not be
+// above current_simd_level(). the order of the floating point operations is
+// not the order of the items, so sums can differ in the last bits from a
+// sequential loop.
+template <class T, class Op>
+T simd_reduce(simd_level level, const T* p, std::size_t n, Op) {
+  using op_t = typename simd_op<Op, T>::type;
+  static_assert(is_simd_type<T>::value && !std::is_void<op_t>::value,
+    "simd_reduce supports float, double, int32_t and int64_t with std::plus, minimum and maximum");
+  switch (level) {
+#if PUSHMI_SIMD_X86
+  case simd_level::avx512:
+    return reduce_avx512<simd_vec<simd_level::avx512, T>>(p, n, op_t{});
+  case simd_level::avx2:
+    return reduce_avx2<simd_vec<simd_level::avx2, T>>(p, n, op_t{});
+  case simd_level::sse42:
+    return reduce_sse42<simd_vec<simd_level::sse42, T>>(p, n, op_t{});
+#endif
+  default:
+    return reduce_scalar(p, n, op_t{});
+  }
+}
+
+template <class T, class Op>
+T simd_reduce(const T* p, std::size_t n, Op op) {
+  return simd_reduce(current_simd_level(), p, n, op);
+}
+
+} // namespace detail
+
+} // namespace pushmi
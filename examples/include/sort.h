@@ -0,0 +1,233 @@
+#pragma once
+
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <pushmi/o/bulk.h>
+#include <pushmi/o/submit.h>
+
+namespace pushmi {
+
+namespace detail {
+
+// a parallel merge sort. the chunks are sorted with std::sort in parallel,
+// then runs are merged pairwise, round by round, between the range and a
+// buffer. each merge is split into parts along its merge path so that the
+// last rounds, which only have one or two merges, still use every worker.
+// out_ is moved from last, so that a state that cannot be built leaves out
+// to the caller.
+template<class It, class Comp, class Out>
+struct sort_state {
+  using value_type = typename std::iterator_traits<It>::value_type;
+
+  struct merge_part {
+    std::size_t a0, a1; // first run in the source
+    std::size_t b0, b1; // second run in the source, empty when moving a run
+    std::size_t k0, k1; // this part of the merged output, relative to a0
+  };
+
+  sort_state(It first, bulk_chunks chunks, std::size_t workers, Comp comp, Out&& out)
+    : first_(first), chunks_(chunks), workers_(workers), comp_(std::move(comp)),
+      runs_(chunk_runs(chunks)), out_(std::move(out)) {}
+
+  static std::vector<std::size_t> chunk_runs(const bulk_chunks& chunks) {
+    std::vector<std::size_t> runs;
+    runs.reserve(chunks.count + 1);
+    for (std::size_t c = 0; c < chunks.count; ++c) {
+      runs.push_back(chunks.first(c));
+    }
+    runs.push_back(chunks.size);
+    return runs;
+  }
+
+  It first_;
+  bulk_chunks chunks_;
+  std::size_t workers_;
+  Comp comp_;
+  std::vector<value_type> buffer_;
+  bool in_buffer_ = false; // where the sorted runs currently live
+  std::vector<std::size_t> runs_; // run boundaries, including the end
+  std::vector<merge_part> parts_;
+  Out out_;
+
+  void sort_chunk(std::size_t c) {
+    std::sort(first_ + chunks_.first(c), first_ + chunks_.last(c), comp_);
+  }
+
+  // the number of items from a that are among the first k items of the
+  // stable merge of a and b.
+  template<class Src>
+  std::size_t co_rank(Src a, std::size_t na, Src b, std::size_t nb, std::size_t k) {
+    std::size_t lo = k > nb ? k - nb : 0;
+    std::size_t hi = std::min(k, na);
+    while (lo < hi) {
+      std::size_t i = lo + (hi - lo) / 2;
+      std::size_t j = k - i;
+      if (j > 0 && !comp_(b[j - 1], a[i])) {
+        lo = i + 1;
+      } else {
+        hi = i;
+      }
+    }
+    return lo;
+  }
+
+  // plans the next round. returns false when only one run is left.
+  bool plan() {
+    const std::size_t count = runs_.size() - 1;
+    if (count <= 1) {
+      return false;
+    }
+    const std::size_t merges = (count + 1) / 2;
+    const std::size_t split = std::max<std::size_t>(1, workers_ / merges);
+    std::vector<std::size_t> next;
+    parts_.clear();
+    for (std::size_t r = 0; r < count; r += 2) {
+      const std::size_t a0 = runs_[r];
+      const std::size_t a1 = runs_[r + 1];
+      const std::size_t b1 = r + 2 < runs_.size() ? runs_[r + 2] : a1;
+      const std::size_t length = b1 - a0;
+      const std::size_t step =
+        std::max(chunks_.chunk, (length + split - 1) / split);
+      for (std::size_t k = 0; k < length; k += step) {
+        parts_.push_back({a0, a1, a1, b1, k, std::min(length, k + step)});
+      }
+      next.push_back(a0);
+    }
+    next.push_back(chunks_.size);
+    runs_ = std::move(next);
+    return true;
+  }
+
+  template<class Src, class Dst>
+  void merge(Src src, Dst dst, const merge_part& p) {
+    auto a = src + p.a0;
+    auto b = src + p.b0;
+    const std::size_t na = p.a1 - p.a0;
+    const std::size_t nb = p.b1 - p.b0;
+    const std::size_t i0 = co_rank(a, na, b, nb, p.k0);
+    const std::size_t i1 = co_rank(a, na, b, nb, p.k1);
+    std::merge(
+      std::make_move_iterator(a + i0), std::make_move_iterator(a + i1),
+      std::make_move_iterator(b + (p.k0 - i0)), std::make_move_iterator(b + (p.k1 - i1)),
+      dst + (p.a0 + p.k0), comp_);
+  }
+  void merge_part_at(std::size_t c) {
+    if (in_buffer_) {
+      merge(buffer_.begin(), first_, parts_[c]);
+    } else {
+      merge(first_, buffer_.begin(), parts_[c]);
+    }
+  }
+  void move_back(std::size_t c) {
+    std::move(
+      buffer_.begin() + chunks_.first(c), buffer_.begin() + chunks_.last(c),
+      first_ + chunks_.first(c));
+  }
+};
+
+template<class Executor, class State>
+void sort_round(Executor e, std::shared_ptr<State> s) {
+  auto fail = [s](std::exception_ptr ep) { ::pushmi::set_error(s->out_, ep); };
+  bool more = false;
+  try {
+    more = s->plan();
+  } catch (...) {
+    return fail(std::current_exception());
+  }
+  if (more) {
+    parallel_chunks(e, s->parts_.size(),
+      [s](std::size_t c) { s->merge_part_at(c); },
+      [e, s, fail](std::exception_ptr ep) {
+        if (ep) {
+          return fail(ep);
+        }
+        s->in_buffer_ = !s->in_buffer_;
+        sort_round(e, s);
+      });
+  } else if (s->in_buffer_) {
+    parallel_chunks(e, s->chunks_.count,
+      [s](std::size_t c) { s->move_back(c); },
+      [s, fail](std::exception_ptr ep) {
+        if (ep) {
+          return fail(ep);
+        }
+        s->buffer_.clear();
+        ::pushmi::set_value(s->out_, s->first_ + s->chunks_.size);
+      });
+  } else {
+    s->buffer_.clear();
+    ::pushmi::set_value(s->out_, s->first_ + s->chunks_.size);
+  }
+}
+
+} // namespace detail
+
+// sort(chunked_target(e), first, last, comp, cutoff) is a single sender that
+// sorts [first, last) on the executor and delivers last. ranges are never
+// split below cutoff items (or the policy grain, if larger); a range shorter
+// than that is sorted with std::sort in a single task. the value type must be
+// default constructible, for the merge buffer. like std::sort, the order of
+// equal items is not preserved.
+template<class Executor, class RandomIt, class Compare = std::less<>>
+auto sort(
+  const detail::chunked_target_t<Executor>& policy,
+  RandomIt first,
+  RandomIt last,
+  Compare comp = Compare{},
+  std::size_t cutoff = 1 << 14) {
+    const std::size_t workers = detail::bulk_workers(policy.workers);
+    const detail::bulk_chunks chunks{
+      static_cast<std::size_t>(last - first), workers,
+      std::max(policy.grain, cutoff)};
+    return make_single_deferred(
+      [e = policy.e, first, chunks, workers, comp](auto out) mutable {
+        using State = detail::sort_state<RandomIt, Compare, decltype(out)>;
+        std::shared_ptr<State> s;
+        try {
+          s = std::make_shared<State>(first, chunks, workers, comp, std::move(out));
+        } catch (...) {
+          ::pushmi::set_error(out, std::current_exception());
+          return;
+        }
+        detail::parallel_chunks(e, chunks.count,
+          [s](std::size_t c) { s->sort_chunk(c); },
+          [e, s](std::exception_ptr ep) {
+            if (ep) {
+              ::pushmi::set_error(s->out_, ep);
+              return;
+            }
+            if (s->chunks_.count > 1) {
+              try {
+                s->buffer_.resize(s->chunks_.size);
+              } catch (...) {
+                ::pushmi::set_error(s->out_, std::current_exception());
+                return;
+              }
+            }
+            detail::sort_round(e, s);
+          });
+      });
+  }
+
+// blocking_sort waits for sort to finish and rethrows its error, if any.
+template<class Executor, class RandomIt, class Compare = std::less<>>
+void blocking_sort(
+  const detail::chunked_target_t<Executor>& policy,
+  RandomIt first,
+  RandomIt last,
+  Compare comp = Compare{},
+  std::size_t cutoff = 1 << 14) {
+    pushmi::sort(policy, first, last, std::move(comp), cutoff) |
+      operators::get<RandomIt>;
+  }
+
+} // namespace pushmi
@@ -0,0 +1,29 @@
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cassert>
+#include <iostream>
+#include <exception>
+
+#include <pool.h>
+#include <reduce.h>
+
+using namespace pushmi::aliases;
+
+int main()
+{
+  mi::pool p{std::max(1u,std::thread::hardware_concurrency())};
+
+  std::vector<int> vec(10);
+  std::fill(vec.begin(), vec.end(), 4);
+
+  auto fortyTwo = mi::reduce(
+    mi::chunked_bulk_target(p.executor(), [](){ return 0; }, std::plus<>{}),
+    vec.begin(), vec.end(), 2, std::plus<>{});
+
+  assert(std::accumulate(vec.begin(), vec.end(), 2) == fortyTwo);
+
+  std::cout << "OK" << std::endl;
+
+  p.wait();
+}
@@ -0,0 +1,74 @@
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <numeric>
+#include <cassert>
+#include <iostream>
+
+#include <pool.h>
+#include <reduce.h>
+
+using namespace pushmi::aliases;
+
+struct sale {
+  std::string region;
+  int amount;
+};
+
+int main()
+{
+  mi::pool p{std::max(1u,std::thread::hardware_concurrency())};
+
+  auto tree = mi::chunked_target(p.executor(), 0, 2);
+
+  std::vector<int> vec(10);
+  std::fill(vec.begin(), vec.end(), 4);
+
+  auto fortyTwo = mi::reduce(tree, vec.begin(), vec.end(), 2, std::plus<>{});
+
+  assert(std::accumulate(vec.begin(), vec.end(), 2) == fortyTwo);
+
+  // move-only accumulator
+  auto boxed = mi::transform_reduce(tree, vec.begin(), vec.end(),
+    std::make_unique<int>(2),
+    [](std::unique_ptr<int> l, std::unique_ptr<int> r){ *l += *r; return l; },
+    [](int v){ return std::make_unique<int>(v); });
+
+  assert(*boxed == fortyTwo);
+  (void)fortyTwo;
+
+  // a chunk count that is not a power of two, the tree has levels of 9, 5,
+  // 3 and 2 partials.
+  auto nine = mi::chunked_target(p.executor(), 9, 1);
+  std::vector<int> odd(9);
+  std::iota(odd.begin(), odd.end(), 1);
+
+  auto sum = mi::reduce(nine, odd.begin(), odd.end(), 0, std::plus<>{});
+  auto squares = mi::transform_reduce(nine, odd.begin(), odd.end(), 0, std::plus<>{},
+    [](int v){ return v * v; });
+
+  assert(sum == 45);
+  assert(squares == 285);
+  (void)sum;
+  (void)squares;
+
+  // map-valued accumulator over a vector of structs
+  std::vector<sale> sales{
+    {"east", 1}, {"west", 2}, {"east", 3}, {"north", 4}, {"west", 5}};
+  using totals = std::map<std::string, int>;
+
+  auto byRegion = mi::reduce(tree, sales.begin(), sales.end(), totals{},
+    [](){ return totals{}; },
+    [](totals acc, const sale& s){ acc[s.region] += s.amount; return acc; },
+    [](totals l, totals r){
+      for (auto& kv : r) { l[kv.first] += kv.second; }
+      return l;
+    });
+
+  assert((byRegion == totals{{"east", 4}, {"north", 4}, {"west", 7}}));
+
+  std::cout << "OK" << std::endl;
+
+  p.wait();
+}
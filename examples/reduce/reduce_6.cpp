@@ -0,0 +1,75 @@
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <cmath>
+#include <cassert>
+#include <iostream>
+
+#include <pool.h>
+#include <reduce.h>
+
+using namespace pushmi::aliases;
+
+// every kernel up to the one for this cpu must agree with std::accumulate,
+// including for sizes that leave a tail after the unrolled loop.
+template<class T>
+void check_kernels(const std::vector<T>& vec) {
+  using mi::detail::simd_level;
+  const auto top = mi::detail::current_simd_level();
+  for (auto level : {simd_level::scalar, simd_level::sse42, simd_level::avx2, simd_level::avx512}) {
+    if (level > top) {
+      break;
+    }
+    for (std::size_t n : {1, 3, 17, 64, 1001, static_cast<int>(vec.size())}) {
+      auto sum = mi::detail::simd_reduce(level, vec.data(), n, std::plus<>{});
+      auto expected = std::accumulate(vec.begin() + 1, vec.begin() + n, vec[0]);
+      assert(std::abs(double(sum - expected)) <= std::abs(double(expected)) * 1e-6);
+      (void)sum;
+      (void)expected;
+      assert(mi::detail::simd_reduce(level, vec.data(), n, mi::minimum{}) ==
+        *std::min_element(vec.begin(), vec.begin() + n));
+      assert(mi::detail::simd_reduce(level, vec.data(), n, mi::maximum{}) ==
+        *std::max_element(vec.begin(), vec.begin() + n));
+    }
+  }
+}
+
+int main()
+{
+  mi::pool p{std::max(1u,std::thread::hardware_concurrency())};
+
+  std::vector<std::int32_t> ints(4099);
+  std::vector<std::int64_t> longs(4099);
+  std::vector<float> floats(4099);
+  std::vector<double> doubles(4099);
+  for (std::size_t i = 0; i < ints.size(); ++i) {
+    ints[i] = std::int32_t((i * 7919) % 1000) - 500;
+    longs[i] = std::int64_t(ints[i]) * (std::int64_t(1) << 33);
+    floats[i] = ints[i] * 0.25f;
+    doubles[i] = ints[i] * 0.125;
+  }
+  check_kernels(ints);
+  check_kernels(longs);
+  check_kernels(floats);
+  check_kernels(doubles);
+
+  static_assert(mi::detail::is_simd_reducible<std::vector<double>::iterator, double, std::plus<>>::value, "");
+  static_assert(!mi::detail::is_simd_reducible<std::vector<double>::iterator, int, std::plus<>>::value, "");
+  static_assert(!mi::detail::is_simd_reducible<int*, int, std::multiplies<>>::value, "");
+  static_assert(mi::detail::is_simd_reducible<double*, double, std::plus<double>>::value, "");
+  static_assert(!mi::detail::is_simd_reducible<double*, double, std::plus<float>>::value, "");
+
+  // the chunked reduce dispatches to the kernels
+  auto policy = mi::chunked_target(p.executor(), 0, 256);
+  auto total = mi::reduce(policy, ints.begin(), ints.end(), std::int32_t(2), std::plus<>{});
+  assert(total == std::accumulate(ints.begin(), ints.end(), std::int32_t(2)));
+  auto lowest = mi::reduce(policy, doubles.begin(), doubles.end(), 0.0, mi::minimum{});
+  assert(lowest == *std::min_element(doubles.begin(), doubles.end()));
+  (void)total;
+  (void)lowest;
+
+  std::cout << "OK" << std::endl;
+
+  p.wait();
+}
@@ -0,0 +1,59 @@
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cassert>
+#include <iostream>
+
+#include <pool.h>
+#include <scan.h>
+
+using namespace pushmi::aliases;
+
+int main()
+{
+  mi::pool p{std::max(1u,std::thread::hardware_concurrency())};
+
+  auto policy = mi::chunked_target(p.executor(), 0, 3);
+
+  std::vector<int> vec(10);
+  std::iota(vec.begin(), vec.end(), 1);
+
+  std::vector<int> inclusive(vec.size());
+  auto iend = mi::inclusive_scan(policy, vec.begin(), vec.end(), inclusive.begin()) |
+    op::get<std::vector<int>::iterator>;
+  std::vector<int> expected(vec.size());
+  std::partial_sum(vec.begin(), vec.end(), expected.begin());
+  assert(iend == inclusive.end());
+  assert(inclusive == expected);
+  (void)iend;
+
+  std::vector<int> exclusive(vec.size());
+  auto xend = mi::exclusive_scan(policy, vec.begin(), vec.end(), exclusive.begin(), 100) |
+    op::get<std::vector<int>::iterator>;
+  // the exclusive scan is the inclusive scan of init followed by all but the
+  // last item.
+  std::vector<int> expected_exclusive{100};
+  expected_exclusive.insert(expected_exclusive.end(), vec.begin(), vec.end() - 1);
+  std::partial_sum(expected_exclusive.begin(), expected_exclusive.end(), expected_exclusive.begin());
+  assert(xend == exclusive.end());
+  assert(exclusive == expected_exclusive);
+  (void)xend;
+
+  std::vector<int> evens(vec.size());
+  auto eend = mi::copy_if(policy, vec.begin(), vec.end(), evens.begin(),
+    [](int v){ return v % 2 == 0; }) |
+    op::get<std::vector<int>::iterator>;
+  evens.erase(eend, evens.end());
+  assert((evens == std::vector<int>{2, 4, 6, 8, 10}));
+
+  auto point = mi::partition(policy, vec.begin(), vec.end(),
+    [](int v){ return v % 3 == 0; }) |
+    op::get<std::vector<int>::iterator>;
+  assert(point == vec.begin() + 3);
+  assert((vec == std::vector<int>{3, 6, 9, 1, 2, 4, 5, 7, 8, 10}));
+  (void)point;
+
+  std::cout << "OK" << std::endl;
+
+  p.wait();
+}
@@ -0,0 +1,56 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <cassert>
+#include <iostream>
+
+#include <pool.h>
+#include <sort.h>
+
+using namespace pushmi::aliases;
+
+int main()
+{
+  mi::pool p{std::max(1u,std::thread::hardware_concurrency())};
+
+  std::mt19937 gen{42};
+  std::vector<int> vec(100000);
+  std::uniform_int_distribution<int> dist{0, 1000};
+  std::generate(vec.begin(), vec.end(), [&]{ return dist(gen); });
+  auto expected = vec;
+  std::sort(expected.begin(), expected.end(), std::greater<>{});
+
+  // small cutoff and 7 workers, so there are several uneven merge rounds
+  auto policy = mi::chunked_target(p.executor(), 7);
+  auto end = mi::sort(policy, vec.begin(), vec.end(), std::greater<>{}, 1000) |
+    op::get<std::vector<int>::iterator>;
+  assert(end == vec.end());
+  assert(vec == expected);
+  (void)end;
+
+  // below the cutoff the whole range is one std::sort
+  std::vector<std::string> words{"pear", "apple", "fig", "kiwi", "banana"};
+  mi::blocking_sort(mi::chunked_target(p.executor()), words.begin(), words.end());
+  assert((words == std::vector<std::string>{"apple", "banana", "fig", "kiwi", "pear"}));
+
+  // many equal keys, with a comparator that only looks at the key
+  std::vector<std::pair<int, int>> pairs;
+  for (int i = 0; i < 20000; ++i) {
+    pairs.emplace_back(i % 3, i);
+  }
+  auto by_key = [](const auto& l, const auto& r){ return l.first < r.first; };
+  mi::blocking_sort(mi::chunked_target(p.executor(), 4), pairs.begin(), pairs.end(),
+    by_key, 5000);
+  assert(std::is_sorted(pairs.begin(), pairs.end(), by_key));
+  assert(std::count_if(pairs.begin(), pairs.end(),
+    [](const auto& v){ return v.first == 1; }) == 6667);
+
+  std::vector<int> empty;
+  mi::blocking_sort(policy, empty.begin(), empty.end());
+
+  std::cout << "OK" << std::endl;
+
+  p.wait();
+}
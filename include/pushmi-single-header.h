@@ -20,11 +20,19 @@
 #include <type_traits>
 #include <initializer_list>
 
+#include <atomic>
 #include <thread>
 #include <future>
 #include <tuple>
 #include <deque>
+#include <map>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
 #include <vector>
+#include <random>
+#include <limits>
+#include <stdexcept>
 
 #if __cpp_lib_optional >= 201606
 #include <optional>
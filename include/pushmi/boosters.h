@@ -34,6 +34,9 @@ struct construct_deduced<none>;
 template<>
 struct construct_deduced<single>;
 
+template<>
+struct construct_deduced<many>;
+
 template <template <class...> class T, class... AN>
 using deduced_type_t = pushmi::invoke_result_t<construct_deduced<T>, AN...>;
 
@@ -141,19 +144,19 @@ struct passDNF {
 // inspired by Ovrld - shown in a presentation by Nicolai Josuttis
 #if __cpp_variadic_using >= 201611 && __cpp_concepts
 template <PUSHMI_TYPE_CONSTRAINT(SemiMovable)... Fns>
-  requires sizeof...(Fns) > 0
+  requires (sizeof...(Fns) > 0)
 struct overload_fn : Fns... {
   constexpr overload_fn() = default;
-  constexpr explicit overload_fn(Fns... fns) requires sizeof...(Fns) == 1
+  constexpr explicit overload_fn(Fns... fns) requires (sizeof...(Fns) == 1)
       : Fns(std::move(fns))... {}
-  constexpr overload_fn(Fns... fns) requires sizeof...(Fns) > 1
+  constexpr overload_fn(Fns... fns) requires (sizeof...(Fns) > 1)
       : Fns(std::move(fns))... {}
   using Fns::operator()...;
 };
 #else
 template <PUSHMI_TYPE_CONSTRAINT(SemiMovable)... Fns>
 #if __cpp_concepts
-  requires sizeof...(Fns) > 0
+  requires (sizeof...(Fns) > 0)
 #endif
 struct overload_fn;
 template <class Fn>
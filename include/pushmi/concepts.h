@@ -21,6 +21,10 @@ struct cardinality_category {};
 
 struct flow_category {};
 
+// stop is a receiver property
+
+struct stop_category {};
+
 // sender and receiver are mutually exclusive
 
 struct receiver_category {};
@@ -115,6 +119,55 @@ PUSHMI_CONCEPT_DEF(
     is_flow_v<PS>
 );
 
+// Stoppable trait and tag
+// a receiver with this property reports a stop_token from get_stop_token()
+template<class... TN>
+struct is_stoppable;
+// Tag
+template<>
+struct is_stoppable<> { using property_category = stop_category; };
+// Trait
+template<class PS>
+struct is_stoppable<PS> : property_query<PS, is_stoppable<>> {};
+template<class PS>
+PUSHMI_INLINE_VAR constexpr bool is_stoppable_v = is_stoppable<PS>::value;
+PUSHMI_CONCEPT_DEF(
+  template (class PS)
+  concept Stoppable,
+    is_stoppable_v<PS>
+);
+
+// receivers that deliver to Data report the stop token of Data, and insert
+// these properties into their own.
+template<class Data>
+using stop_properties_t = std::conditional_t<
+    is_stoppable_v<Data>,
+    property_set<is_stoppable<>>,
+    property_set<>>;
+
+namespace __adl {
+// receivers that are not Stoppable get a token that never stops.
+struct get_stop_token_fn {
+private:
+  PUSHMI_TEMPLATE (class S)
+    (requires Stoppable<remove_cvref_t<S>>)
+  static stop_token impl(S& s, int) noexcept(noexcept(get_stop_token(s))) {
+    return get_stop_token(s);
+  }
+  template <class S>
+  static stop_token impl(S&, long) noexcept {
+    return stop_token{};
+  }
+public:
+  template <class S>
+  stop_token operator()(S&& s) const noexcept(noexcept(impl(s, 0))) {
+    return impl(s, 0);
+  }
+};
+} // namespace __adl
+
+PUSHMI_INLINE_VAR constexpr __adl::get_stop_token_fn get_stop_token{};
+
 // Receiver trait and tag
 template<class... TN>
 struct is_receiver;
@@ -220,6 +273,9 @@ PUSHMI_CONCEPT_DEF(
 PUSHMI_CONCEPT_DEF(
   template (class S, class T, class E = std::exception_ptr)
   (concept ManyReceiver)(S, T, E),
+    requires(S& s, T&& t) (
+      ::pushmi::set_value(s, (T &&) t) // Semantics: called zero or more times.
+    ) &&
     NoneReceiver<S, E> &&
     SemiMovable<T> &&
     SemiMovable<E> &&
@@ -302,8 +358,8 @@ PUSHMI_CONCEPT_DEF(
       class PE = std::exception_ptr,
       class E = PE)
   (concept FlowManyReceiver)(S, Up, T, PE, E),
-    ManyReceiver<S, T, E> && 
-    FlowSingleReceiver<S, Up, T, PE, E>
+    ManyReceiver<S, T, E> &&
+    FlowNoneReceiver<S, Up, PE, E>
 );
 
 PUSHMI_CONCEPT_DEF(
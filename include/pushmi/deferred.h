@@ -5,6 +5,7 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "none.h"
+#include "detail/heap_fallback.h"
 
 namespace pushmi {
 namespace detail {
@@ -43,6 +44,7 @@ class deferred<detail::erase_deferred_t, E> {
       }
     };
     static const vtable vtbl{s::op, s::submit};
+    PUSHMI_HEAP_FALLBACK(deferred, Wrapped);
     data_.pobj_ = new Wrapped(std::move(obj));
     vptr_ = &vtbl;
   }
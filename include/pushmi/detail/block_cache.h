@@ -0,0 +1,187 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace pushmi {
+namespace detail {
+
+// a per-thread cache of blocks for short lived operation state, in size
+// classes of 64, 128, 256 and 512 bytes. a block goes back to the cache of
+// the thread that allocated it: a block that is released on another thread
+// is pushed onto a lock-free list of the owner, which the owner takes over
+// once its own list is empty. each cache keeps at most block_cache_depth
+// blocks per class and returns the rest to the heap, so once the caches are
+// warm, an operation that allocates its state on one thread and releases it
+// on another does not touch the heap either.
+class block_cache {
+  static constexpr std::size_t classes = 4;
+  static constexpr std::size_t smallest = 64;
+  static constexpr std::size_t block_cache_depth = 64;
+
+  struct cache;
+  // every block starts with the cache that it belongs to.
+  struct alignas(std::max_align_t) header {
+    cache* owner;
+  };
+  struct node {
+    node* next;
+  };
+  // the remote lists of a cache whose thread has exited.
+  static node* closed() {
+    static node sentinel{nullptr};
+    return &sentinel;
+  }
+
+  struct cache {
+    node* head[classes] = {};
+    std::size_t count[classes] = {};
+    std::atomic<node*> remote[classes] = {};
+    // the blocks that belong to this cache and are not back on the heap.
+    // a cache outlives its thread until the last of them is freed.
+    std::atomic<std::size_t> blocks{0};
+
+    void take_remote(std::size_t c) {
+      auto n = remote[c].exchange(nullptr, std::memory_order_acquire);
+      std::size_t freed = 0;
+      while (n) {
+        auto next = n->next;
+        if (count[c] < block_cache_depth) {
+          n->next = head[c];
+          head[c] = n;
+          ++count[c];
+        } else {
+          ::operator delete(n);
+          ++freed;
+        }
+        n = next;
+      }
+      if (freed) {
+        blocks.fetch_sub(freed, std::memory_order_relaxed);
+      }
+    }
+    // called by the thread that owns the cache as it exits. blocks that
+    // are released afterwards go back to the heap, and the last one frees
+    // the cache.
+    void close() noexcept {
+      std::size_t freed = 0;
+      for (std::size_t c = 0; c < classes; ++c) {
+        for (auto list : {head[c], remote[c].exchange(closed())}) {
+          while (list) {
+            ::operator delete(std::exchange(list, list->next));
+            ++freed;
+          }
+        }
+      }
+      if (blocks.fetch_sub(freed, std::memory_order_acq_rel) == freed) {
+        delete this;
+      }
+    }
+  };
+
+  struct holder {
+    cache* c = nullptr;
+    ~holder() {
+      if (c) {
+        std::exchange(c, nullptr)->close();
+      }
+    }
+  };
+  static holder& local() {
+    static thread_local holder h;
+    return h;
+  }
+  static std::size_t size_class(std::size_t size) {
+    std::size_t c = 0;
+    for (std::size_t block = smallest; block < size; block *= 2) {
+      ++c;
+    }
+    return c;
+  }
+
+public:
+  template <class T>
+  static constexpr bool cached() {
+    return sizeof(header) + sizeof(T) <= (smallest << (classes - 1)) &&
+        alignof(T) <= alignof(std::max_align_t);
+  }
+
+  template <class T, class... AN>
+  static T* make(AN&&... an) {
+    if (!cached<T>()) {
+      return new T((AN&&) an...);
+    }
+    const auto c = size_class(sizeof(header) + sizeof(T));
+    auto& local = block_cache::local();
+    if (!local.c) {
+      local.c = new cache;
+    }
+    auto& owner = *local.c;
+    if (!owner.head[c]) {
+      owner.take_remote(c);
+    }
+    void* p;
+    if (owner.head[c]) {
+      p = std::exchange(owner.head[c], owner.head[c]->next);
+      --owner.count[c];
+    } else {
+      p = ::operator new(smallest << c);
+      owner.blocks.fetch_add(1, std::memory_order_relaxed);
+    }
+    auto h = ::new (p) header{&owner};
+    try {
+      return ::new (static_cast<void*>(h + 1)) T((AN&&) an...);
+    } catch (...) {
+      release_block(h, c);
+      throw;
+    }
+  }
+
+  template <class T>
+  static void destroy(T* t) noexcept {
+    if (!cached<T>()) {
+      delete t;
+      return;
+    }
+    auto h = reinterpret_cast<header*>(t) - 1;
+    t->~T();
+    release_block(h, size_class(sizeof(header) + sizeof(T)));
+  }
+
+private:
+  static void release_block(header* h, std::size_t c) noexcept {
+    auto owner = h->owner;
+    if (owner == local().c) {
+      if (owner->count[c] == block_cache_depth) {
+        ::operator delete(h);
+        owner->blocks.fetch_sub(1, std::memory_order_relaxed);
+        return;
+      }
+      owner->head[c] = ::new (static_cast<void*>(h)) node{owner->head[c]};
+      ++owner->count[c];
+      return;
+    }
+    auto n = ::new (static_cast<void*>(h)) node{nullptr};
+    auto head = owner->remote[c].load(std::memory_order_relaxed);
+    do {
+      if (head == closed()) {
+        ::operator delete(n);
+        if (owner->blocks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          delete owner;
+        }
+        return;
+      }
+      n->next = head;
+    } while (!owner->remote[c].compare_exchange_weak(
+        head, n, std::memory_order_release, std::memory_order_relaxed));
+  }
+};
+
+} // namespace detail
+} // namespace pushmi
@@ -184,6 +184,12 @@ PUSHMI_PP_IGNORE_CXX2A_COMPAT_BEGIN
 //    template<class A, class B>
 //    inline constexpr bool Name = NameConcept::is_satisfied_by<A, B>(0);
 #if __cpp_concepts
+// the concepts of C++20 drop the 'bool' of the concepts TS
+#if __cpp_concepts >= 201907L
+#define PUSHMI_PP_CONCEPT concept
+#else
+#define PUSHMI_PP_CONCEPT concept bool
+#endif
 // No requires expression
 #define PUSHMI_PP_DEF_IMPL_0(...)                                              \
     __VA_ARGS__                                                                \
@@ -204,7 +210,8 @@ PUSHMI_PP_IGNORE_CXX2A_COMPAT_BEGIN
 #define PUSHMI_PP_DECL_DEF_IMPL(TPARAM, NAME, ARGS, ...)                       \
     inline namespace _eager_ {                                                 \
         PUSHMI_PP_CAT(PUSHMI_PP_DEF_, TPARAM)                                  \
-        concept bool NAME = PUSHMI_PP_DEF_IMPL(__VA_ARGS__)(__VA_ARGS__);      \
+        PUSHMI_PP_CONCEPT NAME =                                              \
+            PUSHMI_PP_DEF_IMPL(__VA_ARGS__)(__VA_ARGS__);                      \
     }                                                                          \
     namespace defer = _eager_;                                                 \
     namespace lazy {                                                           \
@@ -215,7 +222,7 @@ PUSHMI_PP_IGNORE_CXX2A_COMPAT_BEGIN
                 return (bool) defer::NAME<PUSHMI_PP_EXPAND ARGS>;              \
             }                                                                  \
             template <class PMThis = Concept, bool PMB>                        \
-              requires PMB == (bool)PMThis{}                                   \
+              requires (PMB == (bool)PMThis{})                                 \
             constexpr operator std::integral_constant<bool, PMB>() const noexcept {\
                 return {};                                                     \
             }                                                                  \
@@ -372,7 +379,7 @@ PUSHMI_PP_IGNORE_CXX2A_COMPAT_BEGIN
     /**/
 // No requires expression:
 #define PUSHMI_TEMPLATE_AUX_5_0(...)                                           \
-    requires __VA_ARGS__                                                       \
+    requires (__VA_ARGS__)                                                     \
     /**/
 // Requires expression
 #define PUSHMI_TEMPLATE_AUX_5_1(...)                                           \
@@ -413,7 +420,14 @@ PUSHMI_PP_IGNORE_CXX2A_COMPAT_BEGIN
 
 
 #if __cpp_concepts
+// a negated constraint is atomic in C++20, so it only subsumes itself where it
+// is spelled out in the same place. the overloads that rely on subsumption
+// are kept apart explicitly, as they are for the emulation.
+#if __cpp_concepts >= 201907L
+#define PUSHMI_BROKEN_SUBSUMPTION(...) __VA_ARGS__
+#else
 #define PUSHMI_BROKEN_SUBSUMPTION(...)
+#endif
 #define PUSHMI_TYPE_CONSTRAINT(...) __VA_ARGS__
 #define PUSHMI_EXP(...) __VA_ARGS__
 #define PUSHMI_AND &&
@@ -0,0 +1,134 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// the type erased receivers and senders (none, single, many, deferred, ...)
+// keep a wrapped object in their buffer when it fits and move it to the
+// heap when it does not. define PUSHMI_COUNT_HEAP_FALLBACKS to 1 to count
+// the heap fallbacks of each wrapper and wrapped type, ::pushmi::
+// heap_fallbacks() returns the counts. the counting is off by default and
+// costs nothing then. every translation unit of a program should agree on
+// the macro, since it changes the inline constructors of the wrappers.
+#ifndef PUSHMI_COUNT_HEAP_FALLBACKS
+#define PUSHMI_COUNT_HEAP_FALLBACKS 0
+#endif
+
+#if PUSHMI_COUNT_HEAP_FALLBACKS
+#define PUSHMI_HEAP_FALLBACK(Wrapper, Wrapped) \
+  ::pushmi::detail::count_heap_fallback<Wrapper, Wrapped>(#Wrapper)
+#else
+#define PUSHMI_HEAP_FALLBACK(Wrapper, Wrapped) ((void)0)
+#endif
+
+namespace pushmi {
+
+// the heap fallbacks of one wrapped type in one wrapper.
+struct heap_fallback {
+  const char* wrapper;
+  const char* type; // typeid(Wrapped).name()
+  std::size_t size; // sizeof(Wrapped)
+  std::uint64_t count;
+};
+
+namespace detail {
+
+// a counter is registered the first time that a wrapper falls back to the
+// heap for a wrapped type, after that a fallback is one relaxed increment.
+class heap_fallback_registry {
+public:
+  struct counter {
+    const char* wrapper;
+    const std::type_info* type;
+    std::size_t size;
+    std::atomic<std::uint64_t> count{0};
+    counter(const char* w, const std::type_info* t, std::size_t s)
+      : wrapper(w), type(t), size(s) {}
+  };
+
+private:
+  std::mutex lock_;
+  std::deque<counter> counters_; // counters do not move once added
+
+public:
+  static heap_fallback_registry& instance() {
+    static heap_fallback_registry registry;
+    return registry;
+  }
+
+  counter& add(const char* wrapper, const std::type_info& type, std::size_t size) {
+    std::unique_lock<std::mutex> guard{lock_};
+    counters_.emplace_back(wrapper, &type, size);
+    return counters_.back();
+  }
+
+  std::vector<heap_fallback> snapshot() {
+    std::unique_lock<std::mutex> guard{lock_};
+    std::vector<heap_fallback> result;
+    result.reserve(counters_.size());
+    for (auto& c : counters_) {
+      result.push_back(heap_fallback{c.wrapper, c.type->name(), c.size,
+        c.count.load(std::memory_order_relaxed)});
+    }
+    return result;
+  }
+
+  void reset() {
+    std::unique_lock<std::mutex> guard{lock_};
+    for (auto& c : counters_) {
+      c.count.store(0, std::memory_order_relaxed);
+    }
+  }
+};
+
+template <class Wrapper, class Wrapped>
+void count_heap_fallback(const char* wrapper) {
+  static heap_fallback_registry::counter& c =
+    heap_fallback_registry::instance().add(
+      wrapper, typeid(Wrapped), sizeof(Wrapped));
+  c.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+// the heap fallbacks counted so far, one entry per wrapper and wrapped type
+// that has fallen back at least once since the start of the program. empty
+// unless PUSHMI_COUNT_HEAP_FALLBACKS is 1.
+inline std::vector<heap_fallback> heap_fallbacks() {
+  return detail::heap_fallback_registry::instance().snapshot();
+}
+
+// the heap fallbacks counted so far, summed by the size of the wrapped
+// type, as (size, count) pairs in increasing order of size.
+inline std::vector<std::pair<std::size_t, std::uint64_t>> heap_fallbacks_by_size() {
+  std::vector<std::pair<std::size_t, std::uint64_t>> result;
+  for (auto& f : heap_fallbacks()) {
+    auto at = result.begin();
+    while (at != result.end() && at->first < f.size) {
+      ++at;
+    }
+    if (at != result.end() && at->first == f.size) {
+      at->second += f.count;
+    } else {
+      result.insert(at, {f.size, f.count});
+    }
+  }
+  return result;
+}
+
+// sets every count back to 0, for example between the phases of a test.
+inline void reset_heap_fallbacks() {
+  detail::heap_fallback_registry::instance().reset();
+}
+
+} // namespace pushmi
@@ -8,6 +8,7 @@
 #include <functional>
 
 #include "traits.h"
+#include "stop_token.h"
 
 namespace pushmi {
 namespace __adl {
@@ -61,6 +62,18 @@ void submit(SD& sd, TP tp, Out out)
   sd.submit(std::move(tp), std::move(out));
 }
 
+PUSHMI_TEMPLATE (class SD)
+  (requires requires (std::declval<SD&>().is_current()))
+bool is_current(SD& sd) noexcept(noexcept(sd.is_current())) {
+  return sd.is_current();
+}
+
+PUSHMI_TEMPLATE (class S)
+  (requires requires (std::declval<S&>().get_stop_token()))
+auto get_stop_token(S& s) noexcept(noexcept(s.get_stop_token())) {
+  return s.get_stop_token();
+}
+
 template <class T>
 void set_done(std::promise<T>& p) noexcept(
     noexcept(p.set_exception(std::make_exception_ptr(0)))) {
@@ -234,6 +247,26 @@ struct get_now_fn {
   }
 };
 
+// executors that cannot tell whether the calling thread is one of theirs
+// report false, so that work is always submitted to them.
+struct is_current_fn {
+private:
+  PUSHMI_TEMPLATE (class SD)
+    (requires requires ( is_current(std::declval<SD&>()) ))
+  static bool impl(SD& sd, int) noexcept(noexcept(is_current(sd))) {
+    return is_current(sd);
+  }
+  template <class SD>
+  static bool impl(SD&, long) noexcept {
+    return false;
+  }
+public:
+  template <class SD>
+  bool operator()(SD&& sd) const noexcept(noexcept(impl(sd, 0))) {
+    return impl(sd, 0);
+  }
+};
+
 } // namespace __adl
 
 PUSHMI_INLINE_VAR constexpr __adl::set_done_fn set_done{};
@@ -244,6 +277,7 @@ PUSHMI_INLINE_VAR constexpr __adl::set_starting_fn set_starting{};
 PUSHMI_INLINE_VAR constexpr __adl::do_submit_fn submit{};
 PUSHMI_INLINE_VAR constexpr __adl::get_now_fn now{};
 PUSHMI_INLINE_VAR constexpr __adl::get_now_fn top{};
+PUSHMI_INLINE_VAR constexpr __adl::is_current_fn is_current{};
 
 template <class T>
 struct property_set_traits<std::promise<T>> {
@@ -0,0 +1,148 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "flow_many.h"
+#include "detail/heap_fallback.h"
+
+namespace pushmi {
+
+template <class V, class PV, class PE, class E>
+class flow_many_deferred<V, PV, PE, E> {
+  union data {
+    void* pobj_ = nullptr;
+    char buffer_[sizeof(V)]; // can hold a V in-situ
+  } data_{};
+  template <class Wrapped>
+  static constexpr bool insitu() {
+    return sizeof(Wrapped) <= sizeof(data::buffer_) &&
+        std::is_nothrow_move_constructible<Wrapped>::value;
+  }
+  struct vtable {
+    static void s_op(data&, data*) {}
+    static void s_submit(data&, flow_many<V, PV, PE, E>) {}
+    void (*op_)(data&, data*) = vtable::s_op;
+    void (*submit_)(data&, flow_many<V, PV, PE, E>) = vtable::s_submit;
+  };
+  static constexpr vtable const noop_ {};
+  vtable const* vptr_ = &noop_;
+  template <class Wrapped>
+  flow_many_deferred(Wrapped obj, std::false_type) : flow_many_deferred() {
+    struct s {
+      static void op(data& src, data* dst) {
+        if (dst)
+          dst->pobj_ = std::exchange(src.pobj_, nullptr);
+        delete static_cast<Wrapped const*>(src.pobj_);
+      }
+      static void submit(data& src, flow_many<V, PV, PE, E> out) {
+        ::pushmi::submit(*static_cast<Wrapped*>(src.pobj_), std::move(out));
+      }
+    };
+    static const vtable vtbl{s::op, s::submit};
+    PUSHMI_HEAP_FALLBACK(flow_many_deferred, Wrapped);
+    data_.pobj_ = new Wrapped(std::move(obj));
+    vptr_ = &vtbl;
+  }
+  template <class Wrapped>
+  flow_many_deferred(Wrapped obj, std::true_type) noexcept
+    : flow_many_deferred() {
+    struct s {
+      static void op(data& src, data* dst) {
+        if (dst)
+          new (dst->buffer_) Wrapped(
+              std::move(*static_cast<Wrapped*>((void*)src.buffer_)));
+        static_cast<Wrapped const*>((void*)src.buffer_)->~Wrapped();
+      }
+      static void submit(data& src, flow_many<V, PV, PE, E> out) {
+        ::pushmi::submit(
+            *static_cast<Wrapped*>((void*)src.buffer_),
+            std::move(out));
+      }
+    };
+    static const vtable vtbl{s::op, s::submit};
+    new (data_.buffer_) Wrapped(std::move(obj));
+    vptr_ = &vtbl;
+  }
+  template <class T, class U = std::decay_t<T>>
+  using wrapped_t =
+    std::enable_if_t<!std::is_same<U, flow_many_deferred>::value, U>;
+ public:
+  using properties = property_set<is_sender<>, is_flow<>, is_many<>>;
+
+  flow_many_deferred() = default;
+  flow_many_deferred(flow_many_deferred&& that) noexcept
+      : flow_many_deferred() {
+    that.vptr_->op_(that.data_, &data_);
+    std::swap(that.vptr_, vptr_);
+  }
+  PUSHMI_TEMPLATE (class Wrapped)
+    (requires FlowSender<wrapped_t<Wrapped>, is_many<>>)
+  explicit flow_many_deferred(Wrapped obj) noexcept(insitu<Wrapped>())
+    : flow_many_deferred{std::move(obj), bool_<insitu<Wrapped>()>{}} {}
+  ~flow_many_deferred() {
+    vptr_->op_(data_, nullptr);
+  }
+  flow_many_deferred& operator=(flow_many_deferred&& that) noexcept {
+    this->~flow_many_deferred();
+    new ((void*)this) flow_many_deferred(std::move(that));
+    return *this;
+  }
+  void submit(flow_many<V, PV, PE, E> out) {
+    vptr_->submit_(data_, std::move(out));
+  }
+};
+
+// Class static definitions:
+template <class V, class PV, class PE, class E>
+constexpr typename flow_many_deferred<V, PV, PE, E>::vtable const
+    flow_many_deferred<V, PV, PE, E>::noop_;
+
+template <class SF>
+class flow_many_deferred<SF> {
+  SF sf_;
+
+ public:
+  using properties = property_set<is_sender<>, is_flow<>, is_many<>>;
+
+  constexpr flow_many_deferred() = default;
+  constexpr explicit flow_many_deferred(SF sf)
+      : sf_(std::move(sf)) {}
+
+  PUSHMI_TEMPLATE(class Out)
+    (requires Receiver<Out, is_flow<>> && Invocable<SF&, Out>)
+  void submit(Out out) {
+    sf_(std::move(out));
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// make_flow_many_deferred
+PUSHMI_INLINE_VAR constexpr struct make_flow_many_deferred_fn {
+  inline auto operator()() const {
+    return flow_many_deferred<ignoreSF>{};
+  }
+  template <class SF>
+  auto operator()(SF sf) const {
+    return flow_many_deferred<SF>(std::move(sf));
+  }
+} const make_flow_many_deferred {};
+
+////////////////////////////////////////////////////////////////////////////////
+// deduction guides
+#if __cpp_deduction_guides >= 201703
+flow_many_deferred() -> flow_many_deferred<ignoreSF>;
+
+template <class SF>
+flow_many_deferred(SF) -> flow_many_deferred<SF>;
+#endif
+
+template <
+    class V,
+    class PV = std::ptrdiff_t,
+    class PE = std::exception_ptr,
+    class E = PE>
+using any_flow_many_deferred = flow_many_deferred<V, PV, PE, E>;
+
+} // namespace pushmi
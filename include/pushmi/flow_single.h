@@ -5,6 +5,7 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "single.h"
+#include "detail/heap_fallback.h"
 
 namespace pushmi {
 
@@ -60,6 +61,7 @@ class flow_single<V, PE, E> {
       }
     };
     static const vtable vtbl{s::op, s::done, s::error, s::value, s::stopping, s::starting};
+    PUSHMI_HEAP_FALLBACK(flow_single, Wrapped);
     data_.pobj_ = new Wrapped(std::move(obj));
     vptr_ = &vtbl;
   }
@@ -224,7 +226,9 @@ class flow_single<Data, DVF, DEF, DDF, DStpF, DStrtF> {
   DStrtF strtf_;
 
  public:
-  using properties = property_set<is_receiver<>, is_flow<>, is_single<>>;
+  using properties = property_set_insert_t<
+      property_set<is_receiver<>, is_flow<>, is_single<>>,
+      stop_properties_t<Data>>;
 
   static_assert(
       !detail::is_v<DVF, on_error_fn>,
@@ -275,6 +279,9 @@ class flow_single<Data, DVF, DEF, DDF, DStpF, DStrtF> {
   void starting(Up& up) {
     strtf_(data_, up);
   }
+  stop_token get_stop_token() {
+    return ::pushmi::get_stop_token(data_);
+  }
 };
 
 template <>
@@ -5,6 +5,7 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "flow_single.h"
+#include "detail/heap_fallback.h"
 
 namespace pushmi {
 
@@ -40,6 +41,7 @@ class flow_single_deferred<V, PE, E> {
       }
     };
     static const vtable vtbl{s::op, s::submit};
+    PUSHMI_HEAP_FALLBACK(flow_single_deferred, Wrapped);
     data_.pobj_ = new Wrapped(std::move(obj));
     vptr_ = &vtbl;
   }
@@ -34,6 +34,9 @@ struct is_many;
 template<class...TN>
 struct is_flow;
 
+template<class...TN>
+struct is_stoppable;
+
 template<class...TN>
 struct is_receiver;
 
@@ -59,6 +62,9 @@ class single;
 template <PUSHMI_TYPE_CONSTRAINT(SemiMovable)... TN>
 class single_deferred;
 
+template <PUSHMI_TYPE_CONSTRAINT(SemiMovable)... TN>
+class many;
+
 template <PUSHMI_TYPE_CONSTRAINT(SemiMovable)... TN>
 class time_single_deferred;
 
@@ -68,6 +74,12 @@ class flow_single;
 template <PUSHMI_TYPE_CONSTRAINT(SemiMovable)... TN>
 class flow_single_deferred;
 
+template <PUSHMI_TYPE_CONSTRAINT(SemiMovable)... TN>
+class flow_many;
+
+template <PUSHMI_TYPE_CONSTRAINT(SemiMovable)... TN>
+class flow_many_deferred;
+
 template<
   class E = std::exception_ptr,
   class TP = std::chrono::system_clock::time_point,
@@ -17,6 +17,10 @@ struct __new_thread_submit {
     (requires Regular<TP> && Receiver<Out>)
   void operator()(TP at, Out out) const {
     std::thread t{[at = std::move(at), out = std::move(out)]() mutable {
+      if (::pushmi::get_stop_token(out).stop_requested()) {
+        ::pushmi::set_done(out);
+        return;
+      }
       auto tr = trampoline();
       ::pushmi::submit(tr, std::move(at), std::move(out));
     }};
@@ -5,6 +5,7 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "boosters.h"
+#include "detail/heap_fallback.h"
 
 namespace pushmi {
 
@@ -46,6 +47,7 @@ class none<E> {
       }
     };
     static const vtable vtable_v{s::op, s::done, s::error};
+    PUSHMI_HEAP_FALLBACK(none, Wrapped);
     data_.pobj_ = new Wrapped(std::move(obj));
     vptr_ = &vtable_v;
   }
@@ -170,7 +172,9 @@ class none<Data, DEF, DDF> {
     !detail::is_v<Data, single>,
     "none should not be used to wrap a single<>");
 public:
-  using properties = property_set<is_receiver<>, is_none<>>;
+  using properties = property_set_insert_t<
+      property_set<is_receiver<>, is_none<>>,
+      stop_properties_t<Data>>;
 
   constexpr explicit none(Data d) : none(std::move(d), DEF{}, DDF{}) {}
   constexpr none(Data d, DDF df)
@@ -194,6 +198,9 @@ public:
       df_(data_);
     }
   }
+  stop_token get_stop_token() {
+    return ::pushmi::get_stop_token(data_);
+  }
 };
 
 template <>
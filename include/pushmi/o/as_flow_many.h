@@ -0,0 +1,172 @@
+// clang-format off
+// clang format does not support the '<>' in the lambda syntax yet.. []<>()->{}
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "../flow_single_deferred.h"
+#include "../flow_many_deferred.h"
+#include "submit.h"
+#include "extension_operators.h"
+
+namespace pushmi {
+
+namespace detail {
+
+// as_flow_many_state adapts a flow_single sender to a flow_many receiver. the
+// upstream sender is not submitted until the receiver requests at least one
+// value, so the single value never has to be buffered.
+template <class In, class Out>
+struct as_flow_many_state {
+  struct up_receiver {
+    using properties = property_set<is_receiver<>, is_many<>>;
+    as_flow_many_state* s_;
+    void value(std::ptrdiff_t requested) {
+      s_->request(requested);
+    }
+    void error(std::exception_ptr) noexcept {
+      s_->cancel();
+    }
+    void done() {
+      s_->cancel();
+    }
+  };
+
+  template <class Up>
+  struct upstream_ref {
+    using properties = property_set<is_receiver<>, is_none<>>;
+    Up* up_;
+    void error(std::exception_ptr e) noexcept {
+      ::pushmi::set_error(*up_, std::move(e));
+    }
+    void done() {
+      ::pushmi::set_done(*up_);
+    }
+  };
+
+  struct upstream_receiver {
+    using properties = property_set<is_receiver<>, is_flow<>, is_single<>>;
+    std::shared_ptr<as_flow_many_state> s_;
+    template <class V>
+    void value(V&& v) {
+      if (!s_->finish()) {
+        return;
+      }
+      ::pushmi::set_value(s_->out_, (V&&) v);
+      ::pushmi::set_done(s_->out_);
+      s_->self_.reset();
+    }
+    template <class E>
+    void error(E e) noexcept {
+      if (!s_->finish()) {
+        return;
+      }
+      ::pushmi::set_error(s_->out_, std::move(e));
+      s_->self_.reset();
+    }
+    void done() {
+      if (!s_->finish()) {
+        return;
+      }
+      ::pushmi::set_done(s_->out_);
+      s_->self_.reset();
+    }
+    // the upstream acknowledges a cancellation.
+    void stopping() noexcept {
+      if (!s_->finish()) {
+        return;
+      }
+      ::pushmi::set_stopping(s_->out_);
+      s_->self_.reset();
+    }
+    template <class Up>
+    void starting(Up& up) {
+      std::unique_lock<std::mutex> guard{s_->lock_};
+      if (s_->cancelled_) {
+        guard.unlock();
+        ::pushmi::set_done(up);
+        return;
+      }
+      s_->upstream_ = any_none<>{upstream_ref<Up>{&up}};
+    }
+  };
+
+  as_flow_many_state(In in, Out out)
+    : in_(std::move(in)), out_(std::move(out)), up_(up_receiver{this}) {}
+
+  In in_;
+  Out out_;
+  any_many<std::ptrdiff_t> up_;
+  std::atomic<bool> subscribed_{false};
+  std::mutex lock_;
+  bool cancelled_ = false;
+  bool finished_ = false;
+  any_none<> upstream_;
+  std::shared_ptr<as_flow_many_state> self_;
+
+  void request(std::ptrdiff_t requested) {
+    if (requested <= 0 || subscribed_.exchange(true)) {
+      return;
+    }
+    ::pushmi::submit(in_, upstream_receiver{self_});
+  }
+  void cancel() {
+    if (!subscribed_.exchange(true)) {
+      // the upstream was never started, so nothing is in flight.
+      ::pushmi::set_stopping(out_);
+      self_.reset();
+      return;
+    }
+    std::unique_lock<std::mutex> guard{lock_};
+    cancelled_ = true;
+    auto upstream = std::move(upstream_);
+    guard.unlock();
+    ::pushmi::set_done(upstream);
+  }
+  // only the first signal from the upstream is delivered to out_, the caller
+  // releases self_ once it has delivered it.
+  bool finish() {
+    std::unique_lock<std::mutex> guard{lock_};
+    if (finished_) {
+      return false;
+    }
+    finished_ = true;
+    upstream_ = any_none<>{};
+    return true;
+  }
+};
+
+struct as_flow_many_fn {
+  auto operator()() const {
+    return constrain(lazy::FlowSender<_1, is_single<>>, [](auto in) {
+      using In = decltype(in);
+      return make_flow_many_deferred(
+        constrain(lazy::Receiver<_1, is_flow<>>,
+          [in = std::move(in)](auto out) {
+            using State = as_flow_many_state<In, decltype(out)>;
+            auto s = std::make_shared<State>(in, std::move(out));
+            s->self_ = s;
+            ::pushmi::set_starting(s->out_, s->up_);
+          }
+        )
+      );
+    });
+  }
+};
+
+} // namespace detail
+
+namespace operators {
+
+// as_flow_many() adapts a flow_single sender into a flow_many sender. the
+// value is produced once the receiver requests credit through its up-channel.
+PUSHMI_INLINE_VAR constexpr detail::as_flow_many_fn as_flow_many{};
+
+} // namespace operators
+
+} // namespace pushmi
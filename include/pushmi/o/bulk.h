@@ -0,0 +1,469 @@
+// clang-format off
+// clang format does not support the '<>' in the lambda syntax yet.. []<>()->{}
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../single_deferred.h"
+#include "../detail/opt.h"
+#include "submit.h"
+#include "extension_operators.h"
+
+namespace pushmi {
+
+namespace detail {
+
+PUSHMI_INLINE_VAR constexpr std::size_t cache_line_size = 64;
+
+// one accumulator per chunk, each on its own cache line so that workers
+// never write to a line that another worker is writing to.
+template <class T>
+struct alignas(cache_line_size) cache_padded {
+  opt<T> value;
+};
+
+// operator new does not honour extended alignment before C++17, so the slots
+// are aligned by hand inside an over-sized buffer. a Slot other than
+// cache_padded<T> is a cache line aligned struct with a value member.
+template <class T, class Slot = cache_padded<T>>
+class padded_slots {
+  using slot_t = Slot;
+  std::unique_ptr<char[]> storage_;
+  slot_t* slots_ = nullptr;
+  std::size_t size_ = 0;
+ public:
+  explicit padded_slots(std::size_t size)
+    : storage_(new char[sizeof(slot_t) * size + alignof(slot_t)]), size_(size) {
+    void* p = storage_.get();
+    std::size_t space = sizeof(slot_t) * size + alignof(slot_t);
+    p = std::align(alignof(slot_t), sizeof(slot_t) * size, p, space);
+    slots_ = static_cast<slot_t*>(p);
+    for (std::size_t i = 0; i < size_; ++i) {
+      new ((void*)(slots_ + i)) slot_t{};
+    }
+  }
+  padded_slots(const padded_slots&) = delete;
+  padded_slots& operator=(const padded_slots&) = delete;
+  ~padded_slots() {
+    for (std::size_t i = 0; i < size_; ++i) {
+      slots_[i].~slot_t();
+    }
+  }
+  std::size_t size() const {
+    return size_;
+  }
+  auto& operator[](std::size_t i) {
+    return slots_[i].value;
+  }
+};
+
+inline std::size_t bulk_workers(std::size_t workers) {
+  return workers != 0 ? workers :
+    std::max(1u, std::thread::hardware_concurrency());
+}
+
+// splits size items into at most workers contiguous chunks, each holding at
+// least grain items.
+struct bulk_chunks {
+  std::size_t size;
+  std::size_t chunk;
+  std::size_t count;
+
+  bulk_chunks(std::size_t size, std::size_t workers, std::size_t grain)
+    : size(size) {
+    workers = bulk_workers(workers);
+    chunk = std::max(std::max<std::size_t>(grain, 1), (size + workers - 1) / workers);
+    count = (size + chunk - 1) / chunk;
+  }
+  std::size_t first(std::size_t c) const {
+    return c * chunk;
+  }
+  std::size_t last(std::size_t c) const {
+    return std::min(size, first(c) + chunk);
+  }
+};
+
+} // namespace detail
+
+// partition policies understood by chunked_bulk_target.
+
+// one contiguous block per worker, each at least grain items.
+struct auto_partition {
+  std::size_t grain = 1;
+};
+// fixed size chunks dealt round-robin to the workers up front. no state is
+// shared between workers.
+struct static_chunk {
+  std::size_t size = 1;
+};
+// fixed size chunks claimed from a shared counter as workers become free.
+struct dynamic_chunk {
+  std::size_t size = 1;
+};
+// chunks claimed from a shared counter, sized in proportion to the work that
+// is left (never smaller than min), so chunks shrink towards the end.
+struct guided {
+  std::size_t min = 1;
+};
+
+// what each worker of one bulk operation did, for tuning the partition
+// policy. chunked_bulk_target resizes workers to the number of workers it
+// started and fills each entry in before the result is delivered.
+struct bulk_worker_stats {
+  std::size_t iterations = 0;
+  std::size_t chunks = 0;
+};
+struct bulk_stats {
+  std::vector<bulk_worker_stats> workers;
+};
+
+namespace detail {
+
+// a partitioner hands out [first, last) ranges to a worker until it returns
+// false. round counts the calls made by one worker.
+template <class Policy>
+struct partitioner;
+
+template <>
+struct partitioner<auto_partition> {
+  bulk_chunks chunks_;
+  partitioner(auto_partition p, std::size_t size, std::size_t workers)
+    : chunks_(size, workers, p.grain) {}
+  std::size_t workers() const {
+    return chunks_.count;
+  }
+  bool next(std::size_t w, std::size_t& round, std::size_t& first, std::size_t& last) {
+    if (round++ != 0) {
+      return false;
+    }
+    first = chunks_.first(w);
+    last = chunks_.last(w);
+    return true;
+  }
+};
+
+template <>
+struct partitioner<static_chunk> {
+  std::size_t size_;
+  std::size_t chunk_;
+  std::size_t count_;
+  std::size_t workers_;
+  partitioner(static_chunk p, std::size_t size, std::size_t workers)
+    : size_(size), chunk_(std::max<std::size_t>(p.size, 1)),
+      count_((size + chunk_ - 1) / chunk_),
+      workers_(std::min(bulk_workers(workers), count_)) {}
+  std::size_t workers() const {
+    return workers_;
+  }
+  bool next(std::size_t w, std::size_t& round, std::size_t& first, std::size_t& last) {
+    const std::size_t c = w + workers_ * round++;
+    if (c >= count_) {
+      return false;
+    }
+    first = c * chunk_;
+    last = std::min(size_, first + chunk_);
+    return true;
+  }
+};
+
+template <>
+struct partitioner<dynamic_chunk> {
+  std::size_t size_;
+  std::size_t chunk_;
+  std::size_t workers_;
+  std::atomic<std::size_t> next_{0};
+  partitioner(dynamic_chunk p, std::size_t size, std::size_t workers)
+    : size_(size), chunk_(std::max<std::size_t>(p.size, 1)),
+      workers_(std::min(bulk_workers(workers), (size + chunk_ - 1) / chunk_)) {}
+  std::size_t workers() const {
+    return workers_;
+  }
+  bool next(std::size_t, std::size_t& round, std::size_t& first, std::size_t& last) {
+    ++round;
+    first = next_.fetch_add(chunk_, std::memory_order_relaxed);
+    if (first >= size_) {
+      return false;
+    }
+    last = std::min(size_, first + chunk_);
+    return true;
+  }
+};
+
+template <>
+struct partitioner<guided> {
+  std::size_t size_;
+  std::size_t min_;
+  std::size_t workers_;
+  std::atomic<std::size_t> next_{0};
+  partitioner(guided p, std::size_t size, std::size_t workers)
+    : size_(size), min_(std::max<std::size_t>(p.min, 1)),
+      workers_(std::min(bulk_workers(workers), (size + min_ - 1) / min_)) {}
+  std::size_t workers() const {
+    return workers_;
+  }
+  bool next(std::size_t, std::size_t& round, std::size_t& first, std::size_t& last) {
+    ++round;
+    first = next_.load(std::memory_order_relaxed);
+    std::size_t chunk;
+    do {
+      if (first >= size_) {
+        return false;
+      }
+      chunk = std::max(min_, (size_ - first) / workers_);
+    } while (!next_.compare_exchange_weak(
+        first, first + chunk, std::memory_order_relaxed));
+    last = std::min(size_, first + chunk);
+    return true;
+  }
+};
+
+// out_ is the last member and is only moved from once everything else has
+// been built, so that a state that cannot be built leaves out to the caller.
+template <class Acc, class Out, class RS, class F, class CombineF, class Policy>
+struct chunked_bulk_state {
+  chunked_bulk_state(
+      Acc acc, Out&& out, RS selector, F func, CombineF combine, Policy policy,
+      std::size_t size, std::size_t workers, bulk_stats* stats)
+    : acc_(std::move(acc)), selector_(std::move(selector)),
+      func_(std::move(func)), combine_(std::move(combine)),
+      partitioner_(policy, size, workers), slots_(partitioner_.workers()),
+      pending_(partitioner_.workers() + 1),
+      stats_(reset(stats, partitioner_.workers())), out_(std::move(out)) {}
+
+  static bulk_stats* reset(bulk_stats* stats, std::size_t workers) {
+    if (stats) {
+      stats->workers.assign(workers, bulk_worker_stats{});
+    }
+    return stats;
+  }
+
+  Acc acc_;
+  RS selector_;
+  F func_;
+  CombineF combine_;
+  partitioner<Policy> partitioner_;
+  padded_slots<Acc> slots_;
+  std::atomic<std::size_t> pending_;
+  bulk_stats* stats_;
+  std::atomic<std::size_t> exceptions_{0};
+  std::exception_ptr first_exception_;
+  Out out_;
+
+  template <class ShapeBegin, class IdentityF>
+  void work(std::size_t w, ShapeBegin sb, IdentityF& identity) {
+    bulk_worker_stats counted;
+    try {
+      auto& slot = slots_[w];
+      slot = Acc(identity());
+      std::size_t round = 0;
+      std::size_t first = 0;
+      std::size_t last = 0;
+      while (partitioner_.next(w, round, first, last)) {
+        for (auto idx = sb + first, end = sb + last; idx != end; ++idx) {
+          func_(*slot, idx);
+        }
+        counted.iterations += last - first;
+        ++counted.chunks;
+      }
+    } catch (...) {
+      fail();
+    }
+    if (stats_) {
+      stats_->workers[w] = counted;
+    }
+    step_done();
+  }
+  void fail() noexcept {
+    // only the first exception is kept, the rest are dropped
+    if (exceptions_++ == 0) {
+      first_exception_ = std::current_exception();
+    }
+  }
+  void step_done() {
+    if (--pending_ != 0) {
+      return;
+    }
+    if (first_exception_) {
+      ::pushmi::set_error(out_, first_exception_);
+      return;
+    }
+    try {
+      // partials are combined once, in worker order
+      for (std::size_t i = 0; i < slots_.size(); ++i) {
+        acc_ = combine_(std::move(acc_), std::move(*slots_[i]));
+      }
+      auto result = selector_(std::move(acc_));
+      ::pushmi::set_value(out_, std::move(result));
+    } catch (...) {
+      ::pushmi::set_error(out_, std::current_exception());
+    }
+  }
+};
+
+template <class Executor, class IdentityF, class CombineF, class Policy>
+struct chunked_bulk_target_fn {
+  Executor e_;
+  IdentityF identity_;
+  CombineF combine_;
+  Policy policy_;
+  std::size_t workers_;
+  bulk_stats* stats_;
+
+  template <class IF, class RS, class Input, class F, class ShapeBegin,
+    class ShapeEnd, class Out>
+  void operator()(IF init, RS selector, Input input, F&& func, ShapeBegin sb,
+      ShapeEnd se, Out out) const {
+    using Acc = decltype(init(std::move(input)));
+    using Func = std::decay_t<F>;
+    using State = chunked_bulk_state<Acc, Out, RS, Func, CombineF, Policy>;
+    std::shared_ptr<State> state;
+    try {
+      state = std::make_shared<State>(
+        init(std::move(input)), std::move(out), std::move(selector),
+        (F&&) func, combine_, policy_, static_cast<std::size_t>(se - sb),
+        workers_, stats_);
+    } catch (...) {
+      ::pushmi::set_error(out, std::current_exception());
+      return;
+    }
+    const std::size_t workers = state->partitioner_.workers();
+    for (std::size_t w = 0; w < workers; ++w) {
+      try {
+        e_ | operators::submit([state, w, sb, identity = identity_](auto) mutable {
+          state->work(w, sb, identity);
+        });
+      } catch (...) {
+        state->fail();
+        for (; w < workers; ++w) {
+          state->step_done();
+        }
+        break;
+      }
+    }
+    // pending_ starts one above the worker count so that the state cannot
+    // complete while workers are still being submitted.
+    state->step_done();
+  }
+};
+
+} // namespace detail
+
+// chunked_bulk_target is a bulk driver that starts at most one task per
+// worker. the partition policy decides which parts of [sb, se) each worker
+// visits. each worker accumulates into its own slot, starting from
+// identity(), and the slots are folded into init(input) with combine once
+// all workers have finished. when stats is not null it receives per-worker
+// iteration counts.
+PUSHMI_TEMPLATE(class Executor, class IdentityF, class CombineF,
+    class Policy = auto_partition)
+  (requires Sender<Executor> && Invocable<IdentityF&>)
+auto chunked_bulk_target(
+    Executor e,
+    IdentityF identity,
+    CombineF combine,
+    Policy policy = Policy{},
+    std::size_t workers = 0,
+    bulk_stats* stats = nullptr) {
+  return detail::chunked_bulk_target_fn<Executor, IdentityF, CombineF, Policy>{
+    std::move(e), std::move(identity), std::move(combine), std::move(policy),
+    workers, stats};
+}
+
+namespace detail {
+
+template <class Executor>
+struct chunked_target_t {
+  Executor e;
+  std::size_t workers;
+  std::size_t grain;
+};
+
+// runs chunk(c) for each of count chunks as its own task on e. once every
+// chunk has run, then(ep) is called on the thread that ran the last chunk,
+// with the first exception thrown by a chunk, if any.
+template <class Executor, class ChunkF, class ThenF>
+void parallel_chunks(Executor e, std::size_t count, ChunkF chunk, ThenF then) {
+  struct state {
+    state(ChunkF chunk, ThenF then, std::size_t count)
+      : chunk_(std::move(chunk)), then_(std::move(then)), pending_(count + 1) {}
+    ChunkF chunk_;
+    ThenF then_;
+    std::atomic<std::size_t> pending_;
+    std::atomic<std::size_t> exceptions_{0};
+    std::exception_ptr first_exception_;
+    void fail() noexcept {
+      if (exceptions_++ == 0) {
+        first_exception_ = std::current_exception();
+      }
+    }
+    void step_done() {
+      if (--pending_ == 0) {
+        then_(first_exception_);
+      }
+    }
+  };
+  auto s = std::make_shared<state>(std::move(chunk), std::move(then), count);
+  for (std::size_t c = 0; c < count; ++c) {
+    try {
+      e | operators::submit([s, c](auto) {
+        try {
+          s->chunk_(c);
+        } catch (...) {
+          s->fail();
+        }
+        s->step_done();
+      });
+    } catch (...) {
+      s->fail();
+      for (; c < count; ++c) {
+        s->step_done();
+      }
+      break;
+    }
+  }
+  s->step_done();
+}
+
+} // namespace detail
+
+// chunked_target selects the parallel algorithms (reduce, scan, sort, ...)
+// that split their range into at most workers chunks of at least grain
+// items and run one task per chunk on e.
+template <class Executor>
+auto chunked_target(Executor e, std::size_t workers = 0, std::size_t grain = 1) {
+  return detail::chunked_target_t<Executor>{std::move(e), workers, grain};
+}
+
+namespace operators {
+
+template<class F, class ShapeBegin, class ShapeEnd, class Target, class IF, class RS>
+auto bulk(
+    F&& func,
+    ShapeBegin sb,
+    ShapeEnd se,
+    Target&& driver,
+    IF&& initFunc,
+    RS&& selector) {
+  return [func, sb, se, driver, initFunc, selector](auto in){
+    return make_single_deferred(
+      [in, func, sb, se, driver, initFunc, selector](auto out) mutable {
+        ::pushmi::submit(in, make_single(std::move(out),
+          [func, sb, se, driver, initFunc, selector](auto& out, auto input){
+            driver(initFunc, selector, std::move(input), func, sb, se, std::move(out));
+          }
+        ));
+      }
+    );
+  };
+}
+
+} // namespace operators
+
+} // namespace pushmi
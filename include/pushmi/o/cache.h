@@ -0,0 +1,173 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "../single_deferred.h"
+#include "../detail/opt.h"
+#include "extension_operators.h"
+
+namespace pushmi {
+
+namespace detail {
+
+// the values of a cache, split into shards that each have their own lock,
+// so that lookups of different keys rarely contend. entries are expired
+// lazily, without any timer: a lookup ignores and erases an entry that has
+// expired, and a store sweeps the expired entries out of its shard at most
+// once per ttl, so that keys that are never looked up again do not pile up.
+// a timer would have to be submitted to the time executor for every value,
+// and on an executor that runs timers inline, the trampoline for instance,
+// it would hold the thread that delivers the value until the entry expired.
+template <class Key, class T, class Exec, class D>
+class cache_state {
+  using time_point = decltype(::pushmi::now(std::declval<Exec&>()));
+  struct entry {
+    T value_;
+    time_point expires_;
+  };
+  struct shard {
+    std::mutex lock_;
+    std::unordered_map<Key, entry> entries_;
+    time_point sweep_at_{};
+  };
+  static constexpr std::size_t shards = 16;
+  shard shards_[shards];
+
+  shard& shard_for(const Key& key) {
+    return shards_[std::hash<Key>{}(key) % shards];
+  }
+  static void sweep(shard& s, time_point now) {
+    for (auto it = s.entries_.begin(); it != s.entries_.end();) {
+      if (now < it->second.expires_) {
+        ++it;
+      } else {
+        it = s.entries_.erase(it);
+      }
+    }
+  }
+
+public:
+  cache_state(Exec exec, D ttl) : exec_(std::move(exec)), ttl_(ttl) {}
+
+  Exec exec_;
+  const D ttl_;
+
+  opt<T> find(const Key& key) {
+    const auto now = ::pushmi::now(exec_);
+    auto& s = shard_for(key);
+    std::unique_lock<std::mutex> guard{s.lock_};
+    auto found = s.entries_.find(key);
+    if (found == s.entries_.end()) {
+      return {};
+    }
+    if (!(now < found->second.expires_)) {
+      s.entries_.erase(found);
+      return {};
+    }
+    return found->second.value_;
+  }
+
+  void store(const Key& key, T value) {
+    const auto now = ::pushmi::now(exec_);
+    auto expires = now;
+    expires += std::chrono::duration_cast<typename time_point::duration>(ttl_);
+    auto& s = shard_for(key);
+    std::unique_lock<std::mutex> guard{s.lock_};
+    if (!(now < s.sweep_at_)) {
+      sweep(s, now);
+      s.sweep_at_ = expires;
+    }
+    auto found = s.entries_.find(key);
+    if (found == s.entries_.end()) {
+      s.entries_.emplace(key, entry{std::move(value), expires});
+    } else {
+      found->second = entry{std::move(value), expires};
+    }
+  }
+};
+
+template <class State, class Key, class T, class Out>
+struct cache_receiver {
+  using properties = property_set<is_receiver<>, is_single<>, is_stoppable<>>;
+  std::shared_ptr<State> s_;
+  Key key_;
+  Out out_;
+  template <class V>
+  void value(V&& v) {
+    try {
+      s_->store(key_, T(v));
+    } catch (...) {
+      // the value is still delivered, it is only not cached
+    }
+    ::pushmi::set_value(out_, (V&&) v);
+  }
+  template <class E>
+  void error(E e) noexcept {
+    ::pushmi::set_error(out_, std::move(e));
+  }
+  void done() {
+    ::pushmi::set_done(out_);
+  }
+  stop_token get_stop_token() {
+    return ::pushmi::get_stop_token(out_);
+  }
+};
+
+template <class T>
+struct cache_fn {
+  PUSHMI_TEMPLATE(class KeyFn, class D, class Exec)
+    (requires Invocable<const KeyFn&> && Regular<D> && TimeSender<Exec>)
+  auto operator()(KeyFn key_fn, D ttl, Exec exec) const {
+    using Key = std::decay_t<invoke_result_t<const KeyFn&>>;
+    using State = cache_state<Key, T, Exec, D>;
+    auto s = std::make_shared<State>(std::move(exec), ttl);
+    return constrain(lazy::Sender<_1>, [key_fn, s](auto in) {
+      using In = decltype(in);
+      return ::pushmi::detail::deferred_from<In, single<>>(
+        std::move(in),
+        ::pushmi::detail::submit_transform_out<In>(
+          constrain(lazy::Receiver<_2>, [key_fn, s](In& in, auto out) {
+            using Out = decltype(out);
+            auto key = key_fn();
+            if (auto hit = s->find(key)) {
+              ::pushmi::set_value(out, std::move(*hit));
+              return;
+            }
+            ::pushmi::submit(in, cache_receiver<State, Key, T, Out>{
+              s, std::move(key), std::move(out)});
+          }),
+          constrain(lazy::Receiver<_3>, [key_fn, s](In& in, auto at, auto out) {
+            using Out = decltype(out);
+            auto key = key_fn();
+            if (auto hit = s->find(key)) {
+              ::pushmi::set_value(out, std::move(*hit));
+              return;
+            }
+            ::pushmi::submit(in, std::move(at), cache_receiver<State, Key, T, Out>{
+              s, std::move(key), std::move(out)});
+          })
+        )
+      );
+    });
+  }
+};
+
+} // namespace detail
+
+namespace operators {
+// cache<T>(key_fn, ttl, time_exec) remembers the value of in under the key
+// returned by key_fn() for ttl. a submit that finds a value delivers it
+// right away, without submitting in. the entries expire by the clock of
+// time_exec, nothing is ever submitted to it. one cache<T>(...) shares its
+// entries with every sender that it is applied to.
+template <class T>
+PUSHMI_INLINE_VAR constexpr detail::cache_fn<T> cache{};
+} // namespace operators
+
+} // namespace pushmi
@@ -10,6 +10,7 @@
 #include "../piping.h"
 #include "../boosters.h"
 #include "../single.h"
+#include "../many.h"
 #include "../deferred.h"
 #include "../single_deferred.h"
 #include "../time_single_deferred.h"
@@ -50,6 +51,8 @@ template <>
 struct make_receiver<is_none<>> : construct_deduced<none> {};
 template <>
 struct make_receiver<is_single<>> : construct_deduced<single> {};
+template <>
+struct make_receiver<is_many<>> : construct_deduced<many> {};
 
 template <PUSHMI_TYPE_CONSTRAINT(Sender) In>
 struct out_from_fn {
@@ -4,8 +4,9 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
-#include "../piping.h"
+#include "../single_deferred.h"
 #include "extension_operators.h"
+#include "fusion.h"
 
 namespace pushmi {
 
@@ -16,26 +17,29 @@ struct filter_fn {
     (requires SemiMovable<Predicate>)
   auto operator()(Predicate p) const {
     return constrain(lazy::Sender<_1>, [p = std::move(p)](auto in) {
-      using In = decltype(in);
-      return ::pushmi::detail::deferred_from<In, single<>>(
-        std::move(in),
-        ::pushmi::detail::submit_transform_out<In>(
-          constrain(lazy::Receiver<_1>, [p](auto out) {
-            using Out = decltype(out);
-            return ::pushmi::detail::out_from_fn<In>()(
-              std::move(out),
-              // copy 'p' to allow multiple calls to submit
-              ::pushmi::on_value([p](auto& out, auto&& v) {
-                if (p(as_const(v))) {
-                  ::pushmi::set_value(out, std::move(v));
-                } else {
-                  ::pushmi::set_done(out);
-                }
-              })
-            );
-          })
-        )
-      );
+      // a single sender gets p as one more stage of its chain
+      return ::pushmi::detail::fuse(std::move(in), filter_stage<Predicate>{p}, [p](auto in) {
+        using In = decltype(in);
+        return ::pushmi::detail::deferred_from<In, single<>>(
+          std::move(in),
+          ::pushmi::detail::submit_transform_out<In>(
+            constrain(lazy::Receiver<_1>, [p](auto out) {
+              using Out = decltype(out);
+              return ::pushmi::detail::out_from_fn<In>()(
+                std::move(out),
+                // copy 'p' to allow multiple calls to submit
+                ::pushmi::on_value([p](auto& out, auto&& v) {
+                  if (p(as_const(v))) {
+                    ::pushmi::set_value(out, std::move(v));
+                  } else {
+                    ::pushmi::set_done(out);
+                  }
+                })
+              );
+            })
+          )
+        );
+      });
     });
   }
 };
@@ -0,0 +1,142 @@
+// clang-format off
+// clang format does not support the '<>' in the lambda syntax yet.. []<>()->{}
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <atomic>
+#include <memory>
+#include "../flow_many_deferred.h"
+#include "submit.h"
+#include "extension_operators.h"
+
+namespace pushmi {
+
+namespace detail {
+
+namespace flow_from_adl {
+// set_value without the extension point turning an exception from value()
+// into an error on the same receiver, so that the producer can end the flow.
+using ::pushmi::__adl::set_value;
+template <class Out, class V>
+void emit(Out& out, V&& v) {
+  set_value(out, (V&&) v);
+}
+} // namespace flow_from_adl
+
+// flow_from_producer emits the elements of [begin, end) only as fast as the
+// receiver grants credit. credit granted while a drain is in progress (for
+// instance from inside value()) is folded into the running drain, so a
+// receiver that requests one more value from each value() does not grow the
+// stack. the producer keeps itself alive until it has delivered done or has
+// observed a cancellation.
+template <class I, class S, class Out>
+struct flow_from_producer {
+  struct up_receiver {
+    using properties = property_set<is_receiver<>, is_many<>>;
+    flow_from_producer* p_;
+    void value(std::ptrdiff_t requested) {
+      p_->request(requested);
+    }
+    void error(std::exception_ptr) noexcept {
+      p_->cancel();
+    }
+    void done() {
+      p_->cancel();
+    }
+  };
+
+  flow_from_producer(I begin, S end, Out out)
+    : begin_(std::move(begin)), end_(std::move(end)), out_(std::move(out)),
+      up_(up_receiver{this}) {}
+
+  I begin_;
+  S end_;
+  Out out_;
+  any_many<std::ptrdiff_t> up_;
+  std::atomic<std::ptrdiff_t> requested_{0};
+  std::atomic<bool> stop_{false};
+  bool done_ = false;
+  std::shared_ptr<flow_from_producer> self_;
+
+  void request(std::ptrdiff_t requested) {
+    if (requested <= 0) {
+      return;
+    }
+    if (requested_.fetch_add(requested) == 0) {
+      drain(requested);
+    }
+  }
+  void cancel() {
+    stop_.store(true);
+    if (requested_.fetch_add(1) == 0) {
+      drain(1);
+    }
+  }
+  // only the thread that moved requested_ away from zero runs drain(). any
+  // credit added while it runs is picked up before it gives up ownership. a
+  // receiver that throws from value() ends the flow with that error.
+  void drain(std::ptrdiff_t pending) {
+    do {
+      try {
+        for (std::ptrdiff_t i = 0; i < pending && !done_; ++i) {
+          if (stop_.load()) {
+            done_ = true;
+            ::pushmi::set_stopping(out_);
+          } else if (begin_ == end_) {
+            done_ = true;
+            ::pushmi::set_done(out_);
+          } else {
+            flow_from_adl::emit(out_, *begin_);
+            if (++begin_ == end_) {
+              done_ = true;
+              ::pushmi::set_done(out_);
+            }
+          }
+        }
+      } catch (...) {
+        if (!done_) {
+          done_ = true;
+          ::pushmi::set_error(out_, std::current_exception());
+          ::pushmi::set_stopping(out_);
+        }
+      }
+      pending = requested_.fetch_sub(pending) - pending;
+    } while (pending != 0);
+    if (done_) {
+      self_.reset();
+    }
+  }
+};
+
+struct flow_from_fn {
+  PUSHMI_TEMPLATE(class I, class S)
+    (requires SemiMovable<I> && SemiMovable<S>)
+  auto operator()(I begin, S end) const {
+    return make_flow_many_deferred(
+      constrain(lazy::Receiver<_1, is_flow<>>,
+        [begin = std::move(begin), end = std::move(end)](auto out) {
+          using Producer = flow_from_producer<I, S, decltype(out)>;
+          auto p = std::make_shared<Producer>(begin, end, std::move(out));
+          p->self_ = p;
+          // the up-channel is valid until out receives done or stopping.
+          ::pushmi::set_starting(p->out_, p->up_);
+        }
+      )
+    );
+  }
+};
+
+} // namespace detail
+
+namespace operators {
+
+// flow_from(begin, end) is a flow_many sender that emits each element of the
+// range once credit for it has been requested through the up-channel.
+PUSHMI_INLINE_VAR constexpr detail::flow_from_fn flow_from{};
+
+} // namespace operators
+
+} // namespace pushmi
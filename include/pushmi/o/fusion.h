@@ -0,0 +1,226 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <tuple>
+#include <utility>
+#include "../single_deferred.h"
+#include "../time_single_deferred.h"
+#include "extension_operators.h"
+
+namespace pushmi {
+
+namespace detail {
+
+// the stages that transform, filter and tap add to a fused_sender.
+template <class F>
+struct transform_stage {
+  F f_;
+};
+template <class P>
+struct filter_stage {
+  P p_;
+};
+template <class SideEffects>
+struct tap_stage {
+  SideEffects sideEffects_;
+};
+
+// runs every stage of a fused chain in one receiver, so a chain has one
+// done flag and one exception frame instead of one per operator. a stage
+// that throws or filters the value out completes the stages after it, the
+// taps before it have already seen the value.
+template <class Out, class... Stages>
+class fused_receiver {
+  bool done_ = false;
+  Out out_;
+  std::tuple<Stages...> stages_;
+
+  template <std::size_t I>
+  using last = std::integral_constant<bool, I == sizeof...(Stages)>;
+
+  template <std::size_t I, class V>
+  void next(std::size_t&, V&& v, std::true_type) {
+    ::pushmi::set_value(out_, (V&&) v);
+  }
+  template <std::size_t I, class V>
+  void next(std::size_t& stage, V&& v, std::false_type) {
+    stage = I;
+    step<I>(stage, std::get<I>(stages_), (V&&) v);
+  }
+
+  template <std::size_t I, class F, class V>
+  void step(std::size_t& stage, transform_stage<F>& s, V&& v) {
+    using Result = decltype(s.f_((V&&) v));
+    static_assert(::pushmi::SemiMovable<Result>,
+      "none of the functions supplied to transform can convert this value");
+    next<I + 1>(stage, s.f_((V&&) v), last<I + 1>{});
+  }
+  template <std::size_t I, class P, class V>
+  void step(std::size_t& stage, filter_stage<P>& s, V&& v) {
+    if (s.p_(as_const(v))) {
+      next<I + 1>(stage, (V&&) v, last<I + 1>{});
+    } else {
+      done_from(I + 1);
+    }
+  }
+  template <std::size_t I, class SideEffects, class V>
+  void step(std::size_t& stage, tap_stage<SideEffects>& s, V&& v) {
+    ::pushmi::set_value(s.sideEffects_, as_const(v));
+    next<I + 1>(stage, (V&&) v, last<I + 1>{});
+  }
+
+  template <class Stage, class E>
+  static void error_stage(Stage&, const E&) noexcept {}
+  template <class SideEffects, class E>
+  static void error_stage(tap_stage<SideEffects>& s, const E& e) noexcept {
+    ::pushmi::set_error(s.sideEffects_, e);
+  }
+  template <class Stage>
+  static void done_stage(Stage&) {}
+  template <class SideEffects>
+  static void done_stage(tap_stage<SideEffects>& s) {
+    ::pushmi::set_done(s.sideEffects_);
+  }
+
+  template <class E, std::size_t... Is>
+  void error_from(std::size_t from, E e, std::index_sequence<Is...>) noexcept {
+    (void) std::initializer_list<int>{
+      (Is < from ? 0 : (error_stage(std::get<Is>(stages_), e), 0))...};
+    ::pushmi::set_error(out_, std::move(e));
+  }
+  template <std::size_t... Is>
+  void done_from(std::size_t from, std::index_sequence<Is...>) {
+    (void) std::initializer_list<int>{
+      (Is < from ? 0 : (done_stage(std::get<Is>(stages_)), 0))...};
+    ::pushmi::set_done(out_);
+  }
+  template <class E>
+  void error_from(std::size_t from, E e) noexcept {
+    error_from(from, std::move(e), std::index_sequence_for<Stages...>{});
+  }
+  void done_from(std::size_t from) {
+    done_from(from, std::index_sequence_for<Stages...>{});
+  }
+
+public:
+  using properties = property_set_insert_t<
+      property_set<is_receiver<>, is_single<>>,
+      stop_properties_t<Out>>;
+
+  fused_receiver(Out out, std::tuple<Stages...> stages)
+    : out_(std::move(out)), stages_(std::move(stages)) {}
+
+  template <class V>
+  void value(V&& v) noexcept {
+    if (done_) {
+      return;
+    }
+    done_ = true;
+    std::size_t stage = 0;
+    try {
+      next<0>(stage, (V&&) v, last<0>{});
+    } catch (...) {
+      error_from(stage, std::current_exception());
+    }
+  }
+  template <class E>
+  void error(E e) noexcept {
+    if (!done_) {
+      done_ = true;
+      error_from(0, std::move(e));
+    }
+  }
+  void done() {
+    if (!done_) {
+      done_ = true;
+      done_from(0);
+    }
+  }
+  stop_token get_stop_token() {
+    return ::pushmi::get_stop_token(out_);
+  }
+};
+
+template <class In>
+using fused_properties_t = std::conditional_t<
+    (bool) TimeSender<In>,
+    property_set<is_time<>, is_single<>>,
+    property_set<is_sender<>, is_single<>>>;
+
+// a single sender with the stages of a chain of transform, filter and tap.
+// each operator that is applied to a fused_sender adds its stage to the
+// chain instead of wrapping it, so the chain submits one receiver to in.
+template <class In, class... Stages>
+class fused_sender {
+  In in_;
+  std::tuple<Stages...> stages_;
+
+  template <class Out>
+  auto receiver(Out out) {
+    return fused_receiver<Out, Stages...>{std::move(out), stages_};
+  }
+
+public:
+  using properties = fused_properties_t<In>;
+
+  fused_sender(In in, std::tuple<Stages...> stages)
+    : in_(std::move(in)), stages_(std::move(stages)) {}
+
+  template <class Stage>
+  fused_sender<In, Stages..., Stage> then(Stage s) && {
+    return {std::move(in_),
+      std::tuple_cat(std::move(stages_), std::make_tuple(std::move(s)))};
+  }
+
+  PUSHMI_TEMPLATE(class Out, class I = In)
+    (requires Receiver<Out> && not TimeSender<I>)
+  void submit(Out out) {
+    ::pushmi::submit(in_, receiver(std::move(out)));
+  }
+  PUSHMI_TEMPLATE(class I = In)
+    (requires TimeSender<I>)
+  auto now() {
+    return ::pushmi::now(in_);
+  }
+  PUSHMI_TEMPLATE(class TP, class Out, class I = In)
+    (requires Receiver<Out> && TimeSender<I>)
+  void submit(TP at, Out out) {
+    ::pushmi::submit(in_, std::move(at), receiver(std::move(out)));
+  }
+};
+
+// 0 - in keeps its own layer, 1 - in starts a chain, 2 - in is a chain
+template <class In>
+struct fusion
+  : std::integral_constant<int,
+      (bool) Single<properties_t<In>> && !(bool) Flow<properties_t<In>>
+        ? 1 : 0> {};
+template <class In, class... Stages>
+struct fusion<fused_sender<In, Stages...>> : std::integral_constant<int, 2> {};
+
+template <class In, class Stage, class Layer>
+auto fuse_(std::integral_constant<int, 0>, In in, Stage, Layer& layer) {
+  return layer(std::move(in));
+}
+template <class In, class Stage, class Layer>
+auto fuse_(std::integral_constant<int, 1>, In in, Stage stage, Layer&) {
+  return fused_sender<In, Stage>{std::move(in), std::make_tuple(std::move(stage))};
+}
+template <class In, class Stage, class Layer>
+auto fuse_(std::integral_constant<int, 2>, In in, Stage stage, Layer&) {
+  return std::move(in).then(std::move(stage));
+}
+
+// adds stage to the chain of in when in is a single sender, otherwise
+// layer(in) wraps in the way the operator always has.
+template <class In, class Stage, class Layer>
+auto fuse(In in, Stage stage, Layer layer) {
+  return fuse_(fusion<In>{}, std::move(in), std::move(stage), layer);
+}
+
+} // namespace detail
+
+} // namespace pushmi
@@ -21,18 +21,20 @@ struct on_fn {
       return ::pushmi::detail::deferred_from<In, single<>>(
         std::move(in),
         ::pushmi::detail::submit_transform_out<In>(
-          constrain(lazy::SenderTo<In, _2>, [ef](In& in, auto out) {
+          constrain(lazy::Receiver<_2>, [ef](In& in, auto out) {
+            using Out = decltype(out);
             auto exec = ef();
             ::pushmi::submit(exec, ::pushmi::now(exec),
-              ::pushmi::make_single([in = in, out = std::move(out)](auto) mutable {
+              ::pushmi::make_single(std::move(out), [in = in](Out& out, auto) mutable {
                 ::pushmi::submit(in, std::move(out));
               })
             );
           }),
-          constrain(lazy::TimeSenderTo<In, _3>, [ef](In& in, auto at, auto out) {
+          constrain(lazy::Receiver<_3>, [ef](In& in, auto at, auto out) {
+            using Out = decltype(out);
             auto exec = ef();
             ::pushmi::submit(exec, at,
-              ::pushmi::on_value([in = in, at, out = std::move(out)](auto) mutable {
+              ::pushmi::make_single(std::move(out), [in = in, at](Out& out, auto) mutable {
                 ::pushmi::submit(in, at, std::move(out));
               })
             );
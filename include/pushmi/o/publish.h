@@ -0,0 +1,54 @@
+// clang-format off
+// clang format does not support the '<>' in the lambda syntax yet.. []<>()->{}
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "../flow_many.h"
+#include "submit.h"
+#include "extension_operators.h"
+
+#include "../replay_subject.h"
+
+namespace pushmi {
+
+namespace detail {
+
+template<class T>
+struct publish_fn {
+  auto operator()(
+      std::size_t capacity,
+      overflow_policy policy = overflow_policy::drop_oldest) const;
+};
+
+template<class T>
+auto publish_fn<T>::operator()(
+    std::size_t capacity, overflow_policy policy) const {
+  return constrain(lazy::Sender<_1>, [capacity, policy](auto in) {
+    using In = decltype(in);
+    replay_subject<T, properties_t<In>> sub{capacity, policy};
+
+    PUSHMI_IF_CONSTEXPR( ((bool)TimeSender<In>) (
+      ::pushmi::submit(in, ::pushmi::now(id(in)), sub.receiver());
+    ) else (
+      ::pushmi::submit(id(in), sub.receiver());
+    ));
+
+    return sub;
+  });
+}
+
+} // namespace detail
+
+namespace operators {
+
+// in | publish<T>(capacity, policy) submits in once and returns a
+// replay_subject that multicasts its values to any number of flow receivers.
+template<class T>
+PUSHMI_INLINE_VAR constexpr detail::publish_fn<T> publish{};
+
+} // namespace operators
+
+} // namespace pushmi
@@ -0,0 +1,221 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include "../piping.h"
+#include "../stop_token.h"
+#include "submit.h"
+#include "extension_operators.h"
+
+namespace pushmi {
+
+// what a retry policy decides after the upstream has failed.
+struct retry_decision {
+  bool retry;
+  std::chrono::nanoseconds delay;
+};
+
+// a retry policy for op::retry. the n-th retry waits initial * 2^(n-1),
+// capped at max_delay, and there are at most max_retries retries. each
+// delay is shortened by a random fraction of up to jitter, so that clients
+// that failed together do not all retry together.
+class exponential_backoff {
+  std::chrono::nanoseconds initial_;
+  std::chrono::nanoseconds max_delay_;
+  std::size_t max_retries_;
+  double jitter_;
+public:
+  exponential_backoff(
+      std::chrono::nanoseconds initial,
+      std::chrono::nanoseconds max_delay,
+      std::size_t max_retries,
+      double jitter = 0.5)
+    : initial_(initial), max_delay_(max_delay), max_retries_(max_retries),
+      jitter_(jitter) {}
+
+  retry_decision operator()(std::size_t retry) const {
+    if (retry > max_retries_) {
+      return {false, {}};
+    }
+    auto delay = initial_;
+    for (std::size_t i = 1; i < retry && delay < max_delay_; ++i) {
+      delay *= 2;
+    }
+    delay = std::min(delay, max_delay_);
+    thread_local std::minstd_rand engine{std::random_device{}()};
+    std::uniform_real_distribution<double> fraction{0.0, jitter_};
+    return {true, std::chrono::duration_cast<std::chrono::nanoseconds>(
+      delay * (1.0 - fraction(engine)))};
+  }
+};
+
+namespace detail {
+
+template <class In, class Out>
+void retry_submit(In& in, Out out) {
+  PUSHMI_IF_CONSTEXPR( ((bool)TimeSender<In>) (
+    ::pushmi::submit(in, ::pushmi::now(id(in)), std::move(out));
+  ) else (
+    ::pushmi::submit(id(in), std::move(out));
+  ));
+}
+
+// attempts run one after another, so only pending_ is shared between
+// threads. an attempt that fails during submit, with an executor that runs
+// the timer inline, asks for the next attempt while the failed one is still
+// on the stack. that request only bumps pending_ and the attempt loop that
+// is already running makes it, so the stack does not grow with the number
+// of attempts.
+template <class In, class Out, class Policy, class Exec>
+struct retry_state {
+  retry_state(In in, Out out, Policy policy, Exec exec)
+    : in_(std::move(in)), out_(std::move(out)), policy_(std::move(policy)),
+      exec_(std::move(exec)) {}
+  In in_;
+  Out out_;
+  Policy policy_;
+  Exec exec_;
+  std::size_t retries_ = 0;
+  std::atomic<int> pending_{0};
+
+  template <class First>
+  static void start(const std::shared_ptr<retry_state>& s, First first) {
+    s->pending_.store(1, std::memory_order_relaxed);
+    first();
+    drain(s);
+  }
+  static void retry(const std::shared_ptr<retry_state>& s) {
+    if (s->pending_.fetch_add(1, std::memory_order_acq_rel) != 0) {
+      return;
+    }
+    resubmit(s);
+    drain(s);
+  }
+  static void drain(const std::shared_ptr<retry_state>& s) {
+    while (s->pending_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      resubmit(s);
+    }
+  }
+  static void resubmit(const std::shared_ptr<retry_state>& s);
+
+  template <class E>
+  static void fail(const std::shared_ptr<retry_state>& s, E e) noexcept;
+};
+
+template <class State>
+struct retry_receiver {
+  using properties = property_set<is_receiver<>, is_single<>, is_stoppable<>>;
+  std::shared_ptr<State> s_;
+  template <class V>
+  void value(V&& v) {
+    ::pushmi::set_value(s_->out_, (V&&) v);
+  }
+  template <class E>
+  void error(E e) noexcept {
+    State::fail(s_, std::move(e));
+  }
+  void done() {
+    ::pushmi::set_done(s_->out_);
+  }
+  stop_token get_stop_token() const {
+    return ::pushmi::get_stop_token(s_->out_);
+  }
+};
+
+// the value of the timer is the executor that it ran on, which is of no
+// interest here. a timer that cannot run ends the retries.
+template <class State>
+struct retry_timer {
+  using properties = property_set<is_receiver<>, is_single<>, is_stoppable<>>;
+  std::shared_ptr<State> s_;
+  template <class Exec>
+  void value(Exec&&) {
+    State::retry(s_);
+  }
+  template <class E>
+  void error(E e) noexcept {
+    ::pushmi::set_error(s_->out_, std::move(e));
+  }
+  void done() {
+    ::pushmi::set_done(s_->out_);
+  }
+  stop_token get_stop_token() const {
+    return ::pushmi::get_stop_token(s_->out_);
+  }
+};
+
+template <class In, class Out, class Policy, class Exec>
+void retry_state<In, Out, Policy, Exec>::resubmit(
+    const std::shared_ptr<retry_state>& s) {
+  retry_submit(s->in_, retry_receiver<retry_state>{s});
+}
+
+template <class In, class Out, class Policy, class Exec>
+template <class E>
+void retry_state<In, Out, Policy, Exec>::fail(
+    const std::shared_ptr<retry_state>& s, E e) noexcept {
+  try {
+    retry_decision decision = s->policy_(++s->retries_);
+    if (decision.retry &&
+        !::pushmi::get_stop_token(s->out_).stop_requested()) {
+      auto at = ::pushmi::now(s->exec_);
+      at += std::chrono::duration_cast<typename decltype(at)::duration>(
+        decision.delay);
+      s->exec_ | ::pushmi::operators::submit_at(
+        std::move(at), retry_timer<retry_state>{s});
+      return;
+    }
+  } catch (...) {
+    // the retry could not be scheduled, deliver the last error instead
+  }
+  ::pushmi::set_error(s->out_, std::move(e));
+}
+
+struct retry_fn {
+  PUSHMI_TEMPLATE(class Policy, class Exec)
+    (requires TimeSender<Exec>)
+  auto operator()(Policy policy, Exec exec) const {
+    return constrain(lazy::Sender<_1>, [policy, exec](auto in) {
+      using In = decltype(in);
+      return ::pushmi::detail::deferred_from<In, single<>>(
+        std::move(in),
+        ::pushmi::detail::submit_transform_out<In>(
+          constrain(lazy::Receiver<_2>, [policy, exec](In& in, auto out) {
+            using State = retry_state<In, decltype(out), Policy, Exec>;
+            auto s = std::make_shared<State>(in, std::move(out), policy, exec);
+            State::start(s, [&]{
+              ::pushmi::submit(s->in_, retry_receiver<State>{s});
+            });
+          }),
+          constrain(lazy::Receiver<_3>, [policy, exec](In& in, auto at, auto out) {
+            // the first attempt runs at the requested time, the retries as
+            // soon as their delay has passed.
+            using State = retry_state<In, decltype(out), Policy, Exec>;
+            auto s = std::make_shared<State>(in, std::move(out), policy, exec);
+            State::start(s, [&]{
+              ::pushmi::submit(s->in_, std::move(at), retry_receiver<State>{s});
+            });
+          })
+        )
+      );
+    });
+  }
+};
+
+} // namespace detail
+
+namespace operators {
+// in | retry(policy, time_exec) resubmits in each time that it fails, for as
+// long as policy(n), called with the number of the retry, decides to retry.
+// the delays are timers on time_exec, so no thread sleeps while waiting.
+PUSHMI_INLINE_VAR constexpr detail::retry_fn retry{};
+} // namespace operators
+
+} // namespace pushmi
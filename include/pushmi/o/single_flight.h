@@ -0,0 +1,151 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "../single_deferred.h"
+#include "submit.h"
+#include "extension_operators.h"
+
+#include "../subject.h"
+
+namespace pushmi {
+
+namespace detail {
+
+// the subjects of the requests that are in flight, by key. the index is
+// split into shards that each have their own lock, so that requests for
+// different keys rarely contend.
+template <class Key, class T>
+class single_flight_state {
+public:
+  using subject_t = subject<T, property_set<>>;
+
+private:
+  struct shard {
+    std::mutex lock_;
+    std::unordered_map<Key, subject_t> flights_;
+  };
+  static constexpr std::size_t shards = 16;
+  shard shards_[shards];
+
+  shard& shard_for(const Key& key) {
+    return shards_[std::hash<Key>{}(key) % shards];
+  }
+
+public:
+  // the subject of the flight for key and whether it was started by this
+  // call, in which case the caller submits the upstream.
+  std::pair<subject_t, bool> join(const Key& key) {
+    auto& s = shard_for(key);
+    std::unique_lock<std::mutex> guard{s.lock_};
+    auto found = s.flights_.find(key);
+    if (found != s.flights_.end()) {
+      return {found->second, false};
+    }
+    subject_t sub;
+    s.flights_.emplace(key, sub);
+    return {std::move(sub), true};
+  }
+
+  // only the flight that is still indexed under key is removed, a newer
+  // flight for the same key is left alone.
+  void land(const Key& key, const subject_t& sub) {
+    auto& s = shard_for(key);
+    std::unique_lock<std::mutex> guard{s.lock_};
+    auto found = s.flights_.find(key);
+    if (found != s.flights_.end() && found->second.s == sub.s) {
+      s.flights_.erase(found);
+    }
+  }
+};
+
+// the upstream of a flight is shared by every receiver that joined it, so
+// it is not stopped on behalf of any one of them. the key is removed before
+// the subject completes, so a submit that comes after the result starts a
+// new flight.
+template <class State, class Key>
+struct single_flight_receiver {
+  using properties = property_set<is_receiver<>, is_single<>>;
+  using subject_t = typename State::subject_t;
+  std::shared_ptr<State> s_;
+  Key key_;
+  subject_t sub_;
+  template <class V>
+  void value(V&& v) {
+    s_->land(key_, sub_);
+    sub_.s->value((V&&) v);
+  }
+  template <class E>
+  void error(E e) noexcept {
+    s_->land(key_, sub_);
+    sub_.s->error(std::move(e));
+  }
+  void done() {
+    s_->land(key_, sub_);
+    sub_.s->done();
+  }
+};
+
+// out joins the flight for key, the first to join submits in with at, if
+// it is given. when that submit throws, the flight lands with the
+// exception as its error, so that neither the key nor the receivers that
+// joined are left waiting for it.
+template <class State, class Key, class In, class Out, class... TP>
+void single_flight_submit(
+    const std::shared_ptr<State>& s, Key key, In& in, Out out, TP... at) {
+  auto flight = s->join(key);
+  flight.first.submit(std::move(out));
+  if (flight.second) {
+    try {
+      ::pushmi::submit(in, std::move(at)..., single_flight_receiver<State, Key>{
+        s, key, flight.first});
+    } catch (...) {
+      s->land(key, flight.first);
+      flight.first.s->error(std::current_exception());
+    }
+  }
+}
+
+template <class T>
+struct single_flight_fn {
+  PUSHMI_TEMPLATE(class KeyFn)
+    (requires Invocable<const KeyFn&>)
+  auto operator()(KeyFn key_fn) const {
+    using Key = std::decay_t<invoke_result_t<const KeyFn&>>;
+    using State = single_flight_state<Key, T>;
+    auto s = std::make_shared<State>();
+    return constrain(lazy::Sender<_1>, [key_fn, s](auto in) {
+      using In = decltype(in);
+      return ::pushmi::detail::deferred_from<In, single<>>(
+        std::move(in),
+        ::pushmi::detail::submit_transform_out<In>(
+          constrain(lazy::Receiver<_2>, [key_fn, s](In& in, auto out) {
+            single_flight_submit(s, key_fn(), in, std::move(out));
+          }),
+          constrain(lazy::Receiver<_3>, [key_fn, s](In& in, auto at, auto out) {
+            single_flight_submit(s, key_fn(), in, std::move(out), std::move(at));
+          })
+        )
+      );
+    });
+  }
+};
+
+} // namespace detail
+
+namespace operators {
+// single_flight<T>(key_fn) runs at most one submit of in per key at a time.
+// a submit for a key that is already in flight joins that flight and gets
+// its result, as with share<T>, instead of submitting in again. the key is
+// forgotten as soon as the flight completes. one single_flight<T>(...)
+// shares its flights with every sender that it is applied to.
+template <class T>
+PUSHMI_INLINE_VAR constexpr detail::single_flight_fn<T> single_flight{};
+} // namespace operators
+
+} // namespace pushmi
@@ -125,7 +125,16 @@ private:
     template <bool IsTimeSender, class In>
     In impl_(In in) {
       bool done = false;
+      std::mutex lock;
       std::condition_variable signaled;
+      // done is set and signalled under the lock, so that this frame cannot
+      // return and destroy the condition variable while another thread is
+      // still notifying it.
+      auto signal = [&] {
+        std::unique_lock<std::mutex> guard{lock};
+        done = true;
+        signaled.notify_all();
+      };
       auto out{::pushmi::detail::out_from_fn<In>()(
         std::move(args_),
         on_value(constrain(pushmi::lazy::Receiver<_1, is_single<>>,
@@ -140,22 +149,19 @@ private:
             ) else (
               ::pushmi::set_value(out, id((V&&) v));
             ))
-            done = true;
-            signaled.notify_all();
+            signal();
           }
         )),
         on_error(constrain(pushmi::lazy::NoneReceiver<_1, _2>,
           [&](auto out, auto e) noexcept {
             ::pushmi::set_error(out, std::move(e));
-            done = true;
-            signaled.notify_all();
+            signal();
           }
         )),
         on_done(constrain(pushmi::lazy::Receiver<_1>,
           [&](auto out){
             ::pushmi::set_done(out);
-            done = true;
-            signaled.notify_all();
+            signal();
           }
         ))
       )};
@@ -164,7 +170,6 @@ private:
       ) else (
         id(::pushmi::submit)(in, std::move(out));
       ))
-      std::mutex lock;
       std::unique_lock<std::mutex> guard{lock};
       signaled.wait(guard, [&]{
         return done;
@@ -8,6 +8,7 @@
 
 #include <cassert>
 #include "extension_operators.h"
+#include "fusion.h"
 #include "../deferred.h"
 #include "../single_deferred.h"
 #include "../time_single_deferred.h"
@@ -45,6 +46,9 @@ struct tap_ {
     ::pushmi::set_done(sideEffects);
     ::pushmi::set_done(out);
   }
+  stop_token get_stop_token() {
+    return ::pushmi::get_stop_token(out);
+  }
 };
 
 PUSHMI_INLINE_VAR constexpr struct make_tap_fn {
@@ -87,32 +91,37 @@ auto tap_fn::operator()(AN... an) const {
           TimeSenderTo<In, SideEffects, is_single<>> >(),
           "'In' is not deliverable to 'SideEffects'");
 
-      return ::pushmi::detail::deferred_from<In, SideEffects>(
-        std::move(in),
-        ::pushmi::detail::submit_transform_out<In>(
-          constrain(lazy::Receiver<_1>,
-            [sideEffects_ = std::move(sideEffects)](auto out) {
-              using Out = decltype(out);
-              PUSHMI_STATIC_ASSERT(
-                ::pushmi::detail::deferred_requires_from<In, SideEffects,
-                  SenderTo<In, Out, is_none<>>,
-                  SenderTo<In, Out, is_single<>>,
-                  TimeSenderTo<In, Out, is_single<>> >(),
-                  "'In' is not deliverable to 'Out'");
-              auto gang{::pushmi::detail::out_from_fn<In>()(
-                  detail::make_tap(sideEffects_, std::move(out)))};
-              using Gang = decltype(gang);
-              PUSHMI_STATIC_ASSERT(
-                ::pushmi::detail::deferred_requires_from<In, SideEffects,
-                  SenderTo<In, Gang>,
-                  SenderTo<In, Gang, is_single<>>,
-                  TimeSenderTo<In, Gang, is_single<>> >(),
-                  "'In' is not deliverable to 'Out' & 'SideEffects'");
-              return gang;
-            }
+      // a single sender gets the side effects as one more stage of its chain
+      return ::pushmi::detail::fuse(std::move(in), tap_stage<SideEffects>{sideEffects},
+        [sideEffects](auto in) {
+        using In = decltype(in);
+        return ::pushmi::detail::deferred_from<In, SideEffects>(
+          std::move(in),
+          ::pushmi::detail::submit_transform_out<In>(
+            constrain(lazy::Receiver<_1>,
+              [sideEffects_ = std::move(sideEffects)](auto out) {
+                using Out = decltype(out);
+                PUSHMI_STATIC_ASSERT(
+                  ::pushmi::detail::deferred_requires_from<In, SideEffects,
+                    SenderTo<In, Out, is_none<>>,
+                    SenderTo<In, Out, is_single<>>,
+                    TimeSenderTo<In, Out, is_single<>> >(),
+                    "'In' is not deliverable to 'Out'");
+                auto gang{::pushmi::detail::out_from_fn<In>()(
+                    detail::make_tap(sideEffects_, std::move(out)))};
+                using Gang = decltype(gang);
+                PUSHMI_STATIC_ASSERT(
+                  ::pushmi::detail::deferred_requires_from<In, SideEffects,
+                    SenderTo<In, Gang>,
+                    SenderTo<In, Gang, is_single<>>,
+                    TimeSenderTo<In, Gang, is_single<>> >(),
+                    "'In' is not deliverable to 'Out' & 'SideEffects'");
+                return gang;
+              }
+            )
           )
-        )
-      );
+        );
+      });
     }
   );
 }
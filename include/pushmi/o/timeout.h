@@ -0,0 +1,134 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include "../piping.h"
+#include "../stop_token.h"
+#include "submit.h"
+#include "extension_operators.h"
+
+namespace pushmi {
+
+// delivered, as an exception_ptr, when op::timeout expires first.
+struct timeout_error : std::runtime_error {
+  timeout_error() : std::runtime_error("pushmi::timeout expired") {}
+};
+
+namespace detail {
+
+// shared by the upstream receiver and the timer. whichever completes first
+// sets done_ and delivers to out_. done_ is also the stop token handed to
+// both: the upstream sees a stop request when the timer fires, and the
+// timer registration sees one when the upstream finishes first, so an
+// executor that checks the token can drop it without running it. done_ is
+// set with request_stop, which wakes the trampoline, and so new_thread, from
+// the wait for the deadline, so a finished timeout does not hold a thread or
+// out_ until then.
+template <class Out>
+struct timeout_state {
+  explicit timeout_state(Out out) : out_(std::move(out)) {}
+  Out out_;
+  std::atomic<bool> done_{false};
+
+  bool finish() {
+    return ::pushmi::request_stop(done_);
+  }
+  static stop_token token(const std::shared_ptr<timeout_state>& s) {
+    return stop_token{std::shared_ptr<const std::atomic<bool>>(s, &s->done_)};
+  }
+};
+
+template <class State>
+struct timeout_receiver {
+  using properties = property_set<is_receiver<>, is_single<>, is_stoppable<>>;
+  std::shared_ptr<State> s_;
+  template <class V>
+  void value(V&& v) {
+    if (s_->finish()) {
+      ::pushmi::set_value(s_->out_, (V&&) v);
+    }
+  }
+  template <class E>
+  void error(E e) noexcept {
+    if (s_->finish()) {
+      ::pushmi::set_error(s_->out_, std::move(e));
+    }
+  }
+  void done() {
+    if (s_->finish()) {
+      ::pushmi::set_done(s_->out_);
+    }
+  }
+  stop_token get_stop_token() const {
+    return State::token(s_);
+  }
+};
+
+template <class State>
+struct timeout_timer {
+  using properties = property_set<is_receiver<>, is_single<>, is_stoppable<>>;
+  std::shared_ptr<State> s_;
+  template <class Exec>
+  void value(Exec&&) {
+    if (s_->finish()) {
+      ::pushmi::set_error(s_->out_, std::make_exception_ptr(timeout_error{}));
+    }
+  }
+  // a timer that cannot run leaves the upstream to finish on its own.
+  template <class E>
+  void error(E) noexcept {}
+  void done() {}
+  stop_token get_stop_token() const {
+    return State::token(s_);
+  }
+};
+
+struct timeout_fn {
+private:
+  template <class D, class Exec, class State>
+  static void arm(D after, Exec exec, const std::shared_ptr<State>& s) {
+    // nothing to time if the upstream finished during submit
+    if (!s->done_.load(std::memory_order_acquire)) {
+      exec | ::pushmi::operators::submit_after(
+        std::move(after), timeout_timer<State>{s});
+    }
+  }
+public:
+  PUSHMI_TEMPLATE(class D, class Exec)
+    (requires Regular<D> && TimeSender<Exec>)
+  auto operator()(D after, Exec exec) const {
+    return constrain(lazy::Sender<_1>, [after, exec](auto in) {
+      using In = decltype(in);
+      return ::pushmi::detail::deferred_from<In, single<>>(
+        std::move(in),
+        ::pushmi::detail::submit_transform_out<In>(
+          constrain(lazy::Receiver<_2>, [after, exec](In& in, auto out) {
+            using State = timeout_state<decltype(out)>;
+            auto s = std::make_shared<State>(std::move(out));
+            ::pushmi::submit(in, timeout_receiver<State>{s});
+            arm(after, exec, s);
+          }),
+          constrain(lazy::Receiver<_3>, [after, exec](In& in, auto at, auto out) {
+            using State = timeout_state<decltype(out)>;
+            auto s = std::make_shared<State>(std::move(out));
+            ::pushmi::submit(in, std::move(at), timeout_receiver<State>{s});
+            arm(after, exec, s);
+          })
+        )
+      );
+    });
+  }
+};
+
+} // namespace detail
+
+namespace operators {
+PUSHMI_INLINE_VAR constexpr detail::timeout_fn timeout{};
+} // namespace operators
+
+} // namespace pushmi
@@ -9,6 +9,7 @@
 #include "../single.h"
 #include "submit.h"
 #include "extension_operators.h"
+#include "fusion.h"
 
 namespace pushmi {
 
@@ -41,33 +42,36 @@ template <class... FN>
 auto transform_fn::operator()(FN... fn) const {
   auto f = ::pushmi::overload(std::move(fn)...);
   return ::pushmi::constrain(::pushmi::lazy::Sender<::pushmi::_1>, [f = std::move(f)](auto in) {
-    using In = decltype(in);
     // copy 'f' to allow multiple calls to connect to multiple 'in'
     using F = decltype(f);
-    return ::pushmi::detail::deferred_from<In, ::pushmi::single<>>(
-      std::move(in),
-      ::pushmi::detail::submit_transform_out<In>(
-        ::pushmi::constrain(::pushmi::lazy::Receiver<::pushmi::_1>, [f](auto out) {
-          using Out = decltype(out);
-          return ::pushmi::detail::out_from_fn<In>()(
-            std::move(out),
-            // copy 'f' to allow multiple calls to submit
-            ::pushmi::on_value(
-              transform_on_value<F>(f)
-              // [f](Out& out, auto&& v) {
-              //   using V = decltype(v);
-              //   using Result = decltype(f((V&&) v));
-              //   static_assert(::pushmi::SemiMovable<Result>,
-              //     "none of the functions supplied to transform can convert this value");
-              //   static_assert(::pushmi::SingleReceiver<Out, Result>,
-              //     "Result of value transform cannot be delivered to Out");
-              //   ::pushmi::set_value(out, f((V&&) v));
-              // }
-            )
-          );
-        })
-      )
-    );
+    // a single sender gets f as one more stage of its chain
+    return ::pushmi::detail::fuse(std::move(in), transform_stage<F>{f}, [f](auto in) {
+      using In = decltype(in);
+      return ::pushmi::detail::deferred_from<In, ::pushmi::single<>>(
+        std::move(in),
+        ::pushmi::detail::submit_transform_out<In>(
+          ::pushmi::constrain(::pushmi::lazy::Receiver<::pushmi::_1>, [f](auto out) {
+            using Out = decltype(out);
+            return ::pushmi::detail::out_from_fn<In>()(
+              std::move(out),
+              // copy 'f' to allow multiple calls to submit
+              ::pushmi::on_value(
+                transform_on_value<F>(f)
+                // [f](Out& out, auto&& v) {
+                //   using V = decltype(v);
+                //   using Result = decltype(f((V&&) v));
+                //   static_assert(::pushmi::SemiMovable<Result>,
+                //     "none of the functions supplied to transform can convert this value");
+                //   static_assert(::pushmi::SingleReceiver<Out, Result>,
+                //     "Result of value transform cannot be delivered to Out");
+                //   ::pushmi::set_value(out, f((V&&) v));
+                // }
+              )
+            );
+          })
+        )
+      );
+    });
   });
 }
 
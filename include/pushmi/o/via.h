@@ -6,6 +6,7 @@
 
 #include "../piping.h"
 #include "../executor.h"
+#include "../detail/block_cache.h"
 #include "extension_operators.h"
 
 namespace pushmi {
@@ -25,6 +26,116 @@ auto make_via_fn_data(Out out, Executor ex) -> via_fn_data<Executor, Out> {
   return {std::move(out), std::move(ex)};
 }
 
+// when the executor reports that the calling thread is already one of its
+// own, via delivers inline instead of submitting. inline deliveries nest on
+// the stack, so once via_inline_limit of them are nested on a thread the
+// next one is submitted as usual.
+PUSHMI_INLINE_VAR constexpr int via_inline_limit = 16;
+
+struct via_inline {
+  static int& depth() {
+    static thread_local int d = 0;
+    return d;
+  }
+  template <class Executor>
+  static bool allowed(Executor& exec) {
+    return depth() < via_inline_limit && ::pushmi::is_current(exec);
+  }
+  via_inline() {
+    ++depth();
+  }
+  ~via_inline() {
+    --depth();
+  }
+};
+
+// the signal that a hop carries to the executor.
+template <class V>
+struct via_value {
+  V v_;
+  template <class Out>
+  void operator()(Out& out) {
+    ::pushmi::set_value(out, std::move(v_));
+  }
+};
+
+template <class E>
+struct via_error {
+  E e_;
+  template <class Out>
+  void operator()(Out& out) {
+    ::pushmi::set_error(out, std::move(e_));
+  }
+};
+
+struct via_done {
+  template <class Out>
+  void operator()(Out& out) {
+    ::pushmi::set_done(out);
+  }
+};
+
+// the receiver and the pending signal of a hop share one block from
+// block_cache. the executor is given a via_hop, which only points at that
+// block, so it fits the in-situ buffer of a type erased single, and a hop
+// does not allocate once the cache of the thread is warm.
+template <class Out, class Signal>
+struct via_state {
+  via_state(Out out, Signal signal)
+    : out_(std::move(out)), signal_(std::move(signal)) {}
+  Out out_;
+  Signal signal_;
+};
+
+template <class State>
+class via_hop {
+  State* s_;
+  void release() noexcept {
+    block_cache::destroy(std::exchange(s_, nullptr));
+  }
+public:
+  using properties = property_set<is_receiver<>, is_single<>, is_stoppable<>>;
+
+  explicit via_hop(State* s) noexcept : s_(s) {}
+  via_hop(via_hop&& that) noexcept : s_(std::exchange(that.s_, nullptr)) {}
+  via_hop& operator=(via_hop&& that) noexcept {
+    if (s_) {
+      release();
+    }
+    s_ = std::exchange(that.s_, nullptr);
+    return *this;
+  }
+  ~via_hop() {
+    if (s_) {
+      release();
+    }
+  }
+  template <class Exec>
+  void value(Exec&&) {
+    s_->signal_(s_->out_);
+    release();
+  }
+  template <class E>
+  void error(E e) noexcept {
+    ::pushmi::set_error(s_->out_, std::move(e));
+    release();
+  }
+  void done() {
+    ::pushmi::set_done(s_->out_);
+    release();
+  }
+  stop_token get_stop_token() {
+    return ::pushmi::get_stop_token(s_->out_);
+  }
+};
+
+template <class Out, class Executor, class Signal>
+void via_submit(Out& out, Executor& exec, Signal signal) {
+  using State = via_state<Out, Signal>;
+  ::pushmi::submit(exec, ::pushmi::now(exec), via_hop<State>{
+    block_cache::make<State>(std::move(out), std::move(signal))});
+}
+
 struct via_fn {
   PUSHMI_TEMPLATE(class ExecutorFactory)
     (requires Invocable<ExecutorFactory&>)
@@ -42,37 +153,35 @@ struct via_fn {
               // copy 'f' to allow multiple calls to submit
               ::pushmi::on_value([](auto& data, auto&& v) {
                 using V = decltype(v);
-                ::pushmi::submit(
-                  data.exec,
-                  ::pushmi::now(data.exec),
-                  ::pushmi::make_single(
-                    [v = (V&&)v, out = std::move(static_cast<Out&>(data))](auto) mutable {
-                      ::pushmi::set_value(out, std::move(v));
-                    }
-                  )
-                );
+                if (via_inline::allowed(data.exec)) {
+                  via_inline nested;
+                  auto& out = static_cast<Out&>(data);
+                  if (::pushmi::get_stop_token(out).stop_requested()) {
+                    ::pushmi::set_done(out);
+                  } else {
+                    ::pushmi::set_value(out, (V&&) v);
+                  }
+                  return;
+                }
+                via_submit(static_cast<Out&>(data), data.exec,
+                  via_value<std::decay_t<V>>{(V&&) v});
               }),
               ::pushmi::on_error([](auto& data, auto e) noexcept {
-                ::pushmi::submit(
-                  data.exec,
-                  ::pushmi::now(data.exec),
-                  ::pushmi::make_single(
-                    [e = std::move(e), out = std::move(static_cast<Out&>(data))](auto) mutable {
-                      ::pushmi::set_error(out, std::move(e));
-                    }
-                  )
-                );
+                if (via_inline::allowed(data.exec)) {
+                  via_inline nested;
+                  ::pushmi::set_error(static_cast<Out&>(data), std::move(e));
+                  return;
+                }
+                via_submit(static_cast<Out&>(data), data.exec,
+                  via_error<decltype(e)>{std::move(e)});
               }),
               ::pushmi::on_done([](auto& data){
-                ::pushmi::submit(
-                  data.exec,
-                  ::pushmi::now(data.exec),
-                  ::pushmi::make_single(
-                    [out = std::move(static_cast<Out&>(data))](auto) mutable {
-                      ::pushmi::set_done(out);
-                    }
-                  )
-                );
+                if (via_inline::allowed(data.exec)) {
+                  via_inline nested;
+                  ::pushmi::set_done(static_cast<Out&>(data));
+                  return;
+                }
+                via_submit(static_cast<Out&>(data), data.exec, via_done{});
               })
             );
           })
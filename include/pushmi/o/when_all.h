@@ -0,0 +1,256 @@
+// clang-format off
+// clang format does not support the '<>' in the lambda syntax yet.. []<>()->{}
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include "../single.h"
+#include "../single_deferred.h"
+#include "../detail/opt.h"
+#include "bulk.h"
+#include "submit.h"
+#include "extension_operators.h"
+
+namespace pushmi {
+
+namespace detail {
+
+// the join state is a single allocation that owns itself. each branch holds
+// a plain pointer to it, so completing a branch does not touch a reference
+// count, and the branch that brings the countdown to zero delivers the
+// result and deletes the state. the first error or done is delivered as soon
+// as it arrives; the state lives on until every branch has finished.
+template <class Out>
+struct when_all_signal {
+  explicit when_all_signal(Out&& out) : out_(std::move(out)) {}
+  Out out_;
+  std::atomic<bool> signalled_{false};
+
+  template <class E>
+  void error(E e) noexcept {
+    if (!signalled_.exchange(true)) {
+      ::pushmi::set_error(out_, std::move(e));
+    }
+  }
+  void done() {
+    if (!signalled_.exchange(true)) {
+      ::pushmi::set_done(out_);
+    }
+  }
+};
+
+template <class In, class Out>
+void when_all_submit(In& in, Out out) {
+  PUSHMI_IF_CONSTEXPR( ((bool)TimeSender<In>) (
+    ::pushmi::submit(in, ::pushmi::now(id(in)), std::move(out));
+  ) else (
+    ::pushmi::submit(id(in), std::move(out));
+  ));
+}
+
+template <class Out, class... Ts>
+struct when_all_state : when_all_signal<Out> {
+  explicit when_all_state(Out&& out)
+    : when_all_signal<Out>(std::move(out)), pending_(sizeof...(Ts)) {}
+  std::tuple<opt<Ts>...> values_;
+  std::atomic<std::size_t> pending_;
+
+  template <std::size_t... Is>
+  std::tuple<Ts...> take(std::index_sequence<Is...>) {
+    return std::tuple<Ts...>{std::move(*std::get<Is>(values_))...};
+  }
+  void arrive() {
+    if (--pending_ == 0) {
+      if (!this->signalled_.exchange(true)) {
+        ::pushmi::set_value(this->out_, take(std::index_sequence_for<Ts...>{}));
+      }
+      delete this;
+    }
+  }
+  template <std::size_t I, class T, class In>
+  void branch(In& in) {
+    auto s = this;
+    when_all_submit(in, make_single(
+      on_value([s](T t) {
+        std::get<I>(s->values_) = std::move(t);
+        s->arrive();
+      }),
+      on_error([s](auto e) noexcept {
+        s->error(std::move(e));
+        s->arrive();
+      }),
+      on_done([s]() {
+        s->done();
+        s->arrive();
+      })));
+  }
+};
+
+// with many branches a single countdown would be one cache line that every
+// completing thread writes to. branches are counted in blocks instead, and
+// only the last branch of each block decrements the top countdown.
+PUSHMI_INLINE_VAR constexpr std::size_t when_all_block_size = 64;
+
+struct alignas(cache_line_size) when_all_block {
+  std::atomic<std::size_t> value;
+};
+
+// the storage is a base that is built before when_all_signal takes out, so
+// that out is left to the caller when the storage cannot be allocated.
+template <class T>
+struct when_all_range_storage {
+  explicit when_all_range_storage(std::size_t count)
+    : count_(count), values_(new opt<T>[count]), blocks_(blocks(count)),
+      pending_(blocks(count)) {
+    for (std::size_t b = 0; b < blocks(count); ++b) {
+      blocks_[b] = std::min(when_all_block_size, count - b * when_all_block_size);
+    }
+  }
+  static std::size_t blocks(std::size_t count) {
+    return (count + when_all_block_size - 1) / when_all_block_size;
+  }
+  std::size_t count_;
+  std::unique_ptr<opt<T>[]> values_;
+  padded_slots<std::size_t, when_all_block> blocks_;
+  std::atomic<std::size_t> pending_;
+};
+
+template <class Out, class T>
+struct when_all_range_state : when_all_range_storage<T>, when_all_signal<Out> {
+  when_all_range_state(Out&& out, std::size_t count)
+    : when_all_range_storage<T>(count), when_all_signal<Out>(std::move(out)) {}
+
+  void arrive(std::size_t i) {
+    if (--this->blocks_[i / when_all_block_size] != 0 || --this->pending_ != 0) {
+      return;
+    }
+    if (!this->signalled_.exchange(true)) {
+      std::vector<T> result;
+      try {
+        result.reserve(this->count_);
+        for (std::size_t v = 0; v < this->count_; ++v) {
+          result.push_back(std::move(*this->values_[v]));
+        }
+      } catch (...) {
+        ::pushmi::set_error(this->out_, std::current_exception());
+        delete this;
+        return;
+      }
+      ::pushmi::set_value(this->out_, std::move(result));
+    }
+    delete this;
+  }
+  template <class In>
+  void branch(In& in, std::size_t i) {
+    auto s = this;
+    when_all_submit(in, make_single(
+      on_value([s, i](T t) {
+        s->values_[i] = std::move(t);
+        s->arrive(i);
+      }),
+      on_error([s, i](auto e) noexcept {
+        s->error(std::move(e));
+        s->arrive(i);
+      }),
+      on_done([s, i]() {
+        s->done();
+        s->arrive(i);
+      })));
+  }
+};
+
+template <class... Ts>
+struct when_all_fn {
+private:
+  template <class... Senders, std::size_t... Is>
+  static auto impl(std::index_sequence<Is...>, Senders... senders) {
+    return make_single_deferred(
+      [senders...](auto out) mutable {
+        using State = when_all_state<decltype(out), Ts...>;
+        State* s;
+        try {
+          s = new State(std::move(out));
+        } catch (...) {
+          ::pushmi::set_error(out, std::current_exception());
+          return;
+        }
+        std::size_t submitted = 0;
+        try {
+          (void) std::initializer_list<int>{
+            (s->template branch<Is, Ts>(senders), ++submitted, 0)...};
+        } catch (...) {
+          // the branches that were not submitted are completed here
+          s->error(std::current_exception());
+          for (; submitted < sizeof...(Ts); ++submitted) {
+            s->arrive();
+          }
+        }
+      });
+  }
+public:
+  // when_all<T0, T1, ...>(s0, s1, ...) delivers a std::tuple<T0, T1, ...>
+  // once every sender has delivered its value.
+  PUSHMI_TEMPLATE(class... Senders)
+    (requires sizeof...(Senders) == sizeof...(Ts) &&
+      and_v<Sender<Senders>...>)
+  auto operator()(Senders... senders) const {
+    return impl(std::index_sequence_for<Senders...>{}, std::move(senders)...);
+  }
+  // when_all<T>(range) delivers a std::vector<T> with the values of the
+  // senders in range, in order.
+  PUSHMI_TEMPLATE(class Range)
+    (requires sizeof...(Ts) == 1 && not Sender<Range>)
+  auto operator()(Range range) const {
+    using T = std::tuple_element_t<0, std::tuple<Ts...>>;
+    return make_single_deferred(
+      [range = std::move(range)](auto out) mutable {
+        using State = when_all_range_state<decltype(out), T>;
+        using std::begin;
+        using std::end;
+        const auto count = static_cast<std::size_t>(
+          std::distance(begin(range), end(range)));
+        if (count == 0) {
+          ::pushmi::set_value(out, std::vector<T>{});
+          return;
+        }
+        State* s;
+        try {
+          s = new State(std::move(out), count);
+        } catch (...) {
+          ::pushmi::set_error(out, std::current_exception());
+          return;
+        }
+        std::size_t i = 0;
+        try {
+          for (auto& in : range) {
+            s->branch(in, i);
+            ++i;
+          }
+        } catch (...) {
+          // the branches that were not submitted are completed here
+          s->error(std::current_exception());
+          for (; i < count; ++i) {
+            s->arrive(i);
+          }
+        }
+      });
+  }
+};
+
+} // namespace detail
+
+namespace operators {
+
+template <class... Ts>
+PUSHMI_INLINE_VAR constexpr detail::when_all_fn<Ts...> when_all{};
+
+} // namespace operators
+
+} // namespace pushmi
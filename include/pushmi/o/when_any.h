@@ -0,0 +1,206 @@
+// clang-format off
+// clang format does not support the '<>' in the lambda syntax yet.. []<>()->{}
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "../single_deferred.h"
+#include "../stop_token.h"
+#include "submit.h"
+#include "extension_operators.h"
+
+namespace pushmi {
+
+namespace detail {
+
+// the up handle of a flow branch. the winner cancels the branch with
+// set_done(up), which is only valid until the branch finishes, so a branch
+// that finishes on another thread while it is being cancelled waits for
+// the cancel to return. a producer may also finish inside the cancel call,
+// on the cancelling thread, and that must not wait.
+struct when_any_up {
+  enum : int { idle, started, cancelling, cancelled, finished };
+  std::atomic<int> state_{idle};
+  void* up_ = nullptr;
+  void (*cancel_)(void*) = nullptr;
+  std::thread::id canceller_;
+
+  // returns false when the branch was cancelled before it started.
+  template <class Up>
+  bool start(Up& up) {
+    up_ = &up;
+    cancel_ = [](void* p) { ::pushmi::set_done(*static_cast<Up*>(p)); };
+    int expected = idle;
+    return state_.compare_exchange_strong(expected, started);
+  }
+  void cancel() {
+    canceller_ = std::this_thread::get_id();
+    int expected = started;
+    if (state_.compare_exchange_strong(expected, cancelling)) {
+      cancel_(up_);
+      expected = cancelling;
+      state_.compare_exchange_strong(expected, cancelled);
+    } else if (expected == idle) {
+      state_.compare_exchange_strong(expected, cancelled);
+    }
+  }
+  void finish() {
+    int s = state_.load();
+    for (;;) {
+      if (s == cancelling && canceller_ != std::this_thread::get_id()) {
+        std::this_thread::yield();
+        s = state_.load();
+        continue;
+      }
+      if (state_.compare_exchange_weak(s, finished)) {
+        return;
+      }
+    }
+  }
+};
+
+// the first value or error wins and requests stop. the stop flag doubles as
+// the winner flag, so there is nothing to deliver once it is set. if every
+// branch completes with done (or stopping), done is delivered.
+template <class Out, std::size_t N>
+struct when_any_state {
+  explicit when_any_state(Out out) : out_(std::move(out)) {}
+  Out out_;
+  std::atomic<bool> stopped_{false};
+  std::atomic<std::size_t> pending_{N};
+  when_any_up ups_[N];
+
+  static stop_token token(const std::shared_ptr<when_any_state>& s) {
+    return stop_token{std::shared_ptr<const std::atomic<bool>>(s, &s->stopped_)};
+  }
+  bool win() {
+    if (!::pushmi::request_stop(stopped_)) {
+      return false;
+    }
+    for (auto& up : ups_) {
+      up.cancel();
+    }
+    return true;
+  }
+  template <class T>
+  void value(T t) {
+    if (win()) {
+      ::pushmi::set_value(out_, std::move(t));
+    }
+  }
+  template <class E>
+  void error(E e) noexcept {
+    if (win()) {
+      ::pushmi::set_error(out_, std::move(e));
+    }
+  }
+  void done() {
+    if (--pending_ == 0 && !stopped_.exchange(true, std::memory_order_acq_rel)) {
+      ::pushmi::set_done(out_);
+    }
+  }
+};
+
+template <class State, class T>
+struct when_any_receiver {
+  using properties = property_set<is_receiver<>, is_single<>, is_stoppable<>>;
+  std::shared_ptr<State> s_;
+  void value(T t) {
+    s_->value(std::move(t));
+  }
+  template <class E>
+  void error(E e) noexcept {
+    s_->error(std::move(e));
+  }
+  void done() {
+    s_->done();
+  }
+  stop_token get_stop_token() const {
+    return State::token(s_);
+  }
+};
+
+template <class State, class T>
+struct when_any_flow_receiver {
+  using properties = property_set<is_receiver<>, is_flow<>, is_single<>, is_stoppable<>>;
+  std::shared_ptr<State> s_;
+  std::size_t i_;
+  void value(T t) {
+    s_->ups_[i_].finish();
+    s_->value(std::move(t));
+  }
+  template <class E>
+  void error(E e) noexcept {
+    s_->ups_[i_].finish();
+    s_->error(std::move(e));
+  }
+  void done() {
+    s_->ups_[i_].finish();
+    s_->done();
+  }
+  void stopping() noexcept {
+    s_->ups_[i_].finish();
+    s_->done();
+  }
+  template <class Up>
+  void starting(Up& up) {
+    if (!s_->ups_[i_].start(up)) {
+      ::pushmi::set_done(up);
+    }
+  }
+  stop_token get_stop_token() const {
+    return State::token(s_);
+  }
+};
+
+template <class T>
+struct when_any_fn {
+private:
+  template <class State, class In>
+  static void branch(const std::shared_ptr<State>& s, std::size_t i, In& in) {
+    PUSHMI_IF_CONSTEXPR( ((bool)FlowSender<In>) (
+      ::pushmi::submit(in, when_any_flow_receiver<State, T>{s, i});
+    ) else (
+      PUSHMI_IF_CONSTEXPR( ((bool)TimeSender<In>) (
+        ::pushmi::submit(in, ::pushmi::now(id(in)), when_any_receiver<State, T>{s});
+      ) else (
+        ::pushmi::submit(id(in), when_any_receiver<State, T>{s});
+      ));
+    ));
+  }
+  template <class... Senders, std::size_t... Is>
+  static auto impl(std::index_sequence<Is...>, Senders... senders) {
+    return make_single_deferred(
+      [senders...](auto out) mutable {
+        using State = when_any_state<decltype(out), sizeof...(Senders)>;
+        auto s = std::make_shared<State>(std::move(out));
+        (void) std::initializer_list<int>{(branch(s, Is, senders), 0)...};
+      });
+  }
+public:
+  // when_any<T>(s0, s1, ...) delivers the first value or error from any of
+  // the senders, then cancels the others: flow senders through set_done on
+  // their up handle and other senders through the stop token that their
+  // receiver reports from get_stop_token.
+  PUSHMI_TEMPLATE(class... Senders)
+    (requires sizeof...(Senders) != 0 && and_v<Sender<Senders>...>)
+  auto operator()(Senders... senders) const {
+    return impl(std::index_sequence_for<Senders...>{}, std::move(senders)...);
+  }
+};
+
+} // namespace detail
+
+namespace operators {
+
+template <class T>
+PUSHMI_INLINE_VAR constexpr detail::when_any_fn<T> when_any{};
+
+} // namespace operators
+
+} // namespace pushmi
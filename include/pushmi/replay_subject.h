@@ -0,0 +1,413 @@
+#pragma once
+
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include <pushmi/detail/opt.h>
+#include <pushmi/flow_many_deferred.h>
+
+namespace pushmi {
+
+// what a replay_subject does when it needs the slot of a value that a
+// receiver has not read yet.
+enum class overflow_policy {
+  drop_oldest, // the receiver skips the values that are overwritten
+  block,       // the producer waits until the receiver has read the value
+  error        // the receiver is completed with replay_overflow
+};
+
+struct replay_overflow : std::runtime_error {
+  replay_overflow() : std::runtime_error("pushmi::replay_subject overflowed") {}
+};
+
+template<class... TN>
+struct replay_subject;
+
+// a replay_subject is a flow_many sender that multicasts the values of one
+// producer. the values are kept in a ring of capacity slots that every
+// receiver reads by const reference at its own pace, as fast as it requests
+// them through the up-channel. a receiver that is submitted late first
+// replays the values that are still in the ring.
+//
+// value(), error() and done() of the receiver() must not be called
+// concurrently. with overflow_policy::block, a receiver that stops
+// requesting values stops the producer. once the subject and every copy of
+// its receiver() are gone, nothing can produce a value any more, and the
+// receivers that are still reading are completed with done.
+template<class T, class PS>
+struct replay_subject<T, PS> {
+
+  using properties = property_set_insert_t<
+    property_set<is_sender<>, is_flow<>, is_many<>>, PS>;
+
+  struct replay_shared : std::enable_shared_from_this<replay_shared> {
+    // the cursor of a reader is the sequence number of the next value that
+    // it reads, shifted left by one. the low bit is set while the reader is
+    // in value(), so that the producer does not overwrite that slot.
+    static constexpr std::uint64_t closed = ~std::uint64_t{0};
+
+    struct reader {
+      using drain_fn = std::shared_ptr<replay_shared> (*)(reader*);
+      reader(drain_fn drain, void (*destroy)(reader*))
+        : drain_(drain), destroy_(destroy) {}
+      reader* next_ = nullptr;
+      std::atomic<std::uint64_t> cursor_{0};
+      std::atomic<std::ptrdiff_t> credit_{0};
+      // submit owns the first drain, so that the producer cannot signal out
+      // before it has received starting.
+      std::atomic<std::ptrdiff_t> work_{1};
+      std::atomic<bool> cancelled_{false};
+      std::atomic<bool> overflowed_{false};
+      // set once out has received done, error or stopping, and not while
+      // it receives them, in case out calls back into the subject.
+      std::atomic<bool> finished_{false};
+      // submit and calls on the up-channel pin the reader while they use
+      // it, so that the producer does not free it under them. submit holds
+      // the first pin.
+      std::atomic<int> pins_{1};
+      drain_fn drain_;
+      void (*destroy_)(reader*);
+
+      void unpin() {
+        pins_.fetch_sub(1);
+      }
+      // a finished reader that is not pinned is not used by anyone but the
+      // producer, which can unlink and free it.
+      bool reclaimable() const {
+        return finished_.load() && pins_.load() == 0;
+      }
+
+      // only the thread that moves work_ away from zero drains. work that
+      // is added while it drains, from inside value() for instance, is
+      // picked up before it gives up ownership.
+      //
+      // a reader that finishes lets go of the subject, which may be the last
+      // reference to it and to the reader. kick() returns that reference,
+      // the caller releases it once it has unpinned the reader.
+      std::shared_ptr<replay_shared> kick() {
+        if (work_.fetch_add(1) == 0) {
+          return drain_(this);
+        }
+        return {};
+      }
+    };
+
+    template <class Out>
+    struct reader_for : reader {
+      struct up_receiver {
+        using properties = property_set<is_receiver<>, is_many<>>;
+        reader_for* r_;
+        void value(std::ptrdiff_t requested) {
+          if (requested > 0) {
+            r_->pins_.fetch_add(1);
+            r_->credit_.fetch_add(requested);
+            auto keep = r_->kick();
+            r_->unpin();
+          }
+        }
+        void error(std::exception_ptr) noexcept {
+          r_->cancel();
+        }
+        void done() {
+          r_->cancel();
+        }
+      };
+
+      reader_for(std::shared_ptr<replay_shared> owner, Out out)
+        : reader(&reader_for::drain, &reader_for::destroy),
+          owner_(std::move(owner)), out_(std::move(out)),
+          up_(up_receiver{this}) {}
+
+      // the reader keeps the subject alive until it has delivered done,
+      // error or stopping.
+      std::shared_ptr<replay_shared> owner_;
+      Out out_;
+      any_many<std::ptrdiff_t> up_;
+
+      void cancel() {
+        this->pins_.fetch_add(1);
+        this->cancelled_.store(true);
+        auto keep = this->kick();
+        this->unpin();
+      }
+      static void destroy(reader* r) {
+        delete static_cast<reader_for*>(r);
+      }
+      static std::shared_ptr<replay_shared> drain(reader* r) {
+        auto self = static_cast<reader_for*>(r);
+        std::shared_ptr<replay_shared> keep;
+        std::ptrdiff_t pending = 1;
+        do {
+          self->step(keep);
+          pending = self->work_.fetch_sub(pending) - pending;
+        } while (pending != 0);
+        return keep;
+      }
+      // keep is handed back to the caller of kick(), after the signal has
+      // been delivered.
+      void finish(std::shared_ptr<replay_shared>& keep) {
+        this->cursor_.store(closed);
+        keep = std::move(owner_);
+      }
+      void step(std::shared_ptr<replay_shared>& keep) {
+        if (!owner_) {
+          return;
+        }
+        auto& s = *owner_;
+        for (;;) {
+          if (this->cancelled_.load()) {
+            finish(keep);
+            ::pushmi::set_stopping(out_);
+            this->finished_.store(true);
+            return;
+          }
+          if (this->overflowed_.load()) {
+            finish(keep);
+            ::pushmi::set_error(out_, std::make_exception_ptr(replay_overflow{}));
+            this->finished_.store(true);
+            return;
+          }
+          auto cursor = this->cursor_.load();
+          if (cursor == closed) {
+            // overflowed_ is about to be set and the reader kicked again
+            return;
+          }
+          const auto seq = cursor >> 1;
+          const bool complete = s.complete_.load(std::memory_order_acquire);
+          if (seq == s.tail_.load(std::memory_order_acquire)) {
+            if (complete) {
+              finish(keep);
+              keep->end(out_);
+              this->finished_.store(true);
+            }
+            return;
+          }
+          if (this->credit_.load() == 0) {
+            return;
+          }
+          if (!this->cursor_.compare_exchange_strong(cursor, cursor | 1)) {
+            continue;
+          }
+          this->credit_.fetch_sub(1);
+          ::pushmi::set_value(out_, (const T&) *s.slots_[seq % s.size_]);
+          this->cursor_.store((seq + 1) << 1);
+        }
+      }
+    };
+
+    replay_shared(std::size_t capacity, overflow_policy policy)
+      : size_(capacity + 1), policy_(policy),
+        slots_(new pushmi::detail::opt<T>[capacity + 1]) {}
+
+    ~replay_shared() {
+      auto r = readers_.load(std::memory_order_relaxed);
+      while (r) {
+        auto next = r->next_;
+        r->destroy_(r);
+        r = next;
+      }
+    }
+
+    // one slot more than the capacity, so that a reader that is submitted
+    // while a value is written can still replay capacity values.
+    const std::uint64_t size_;
+    const overflow_policy policy_;
+    std::unique_ptr<pushmi::detail::opt<T>[]> slots_;
+    std::atomic<std::uint64_t> tail_{0};
+    std::atomic<bool> complete_{false};
+    std::exception_ptr ep_;
+    std::atomic<reader*> readers_{nullptr};
+
+    std::uint64_t oldest(std::uint64_t tail) const {
+      return tail < size_ ? 0 : tail - (size_ - 1);
+    }
+
+    template <class Out>
+    void end(Out& out) {
+      if (ep_) {
+        ::pushmi::set_error(out, ep_);
+      } else {
+        ::pushmi::set_done(out);
+      }
+    }
+
+    template <class Out>
+    void submit(Out out) {
+      auto r = new reader_for<Out>{this->shared_from_this(), std::move(out)};
+      r->cursor_.store(oldest(tail_.load()) << 1);
+      auto head = readers_.load();
+      do {
+        r->next_ = head;
+      } while (!readers_.compare_exchange_weak(head, r));
+      // values written before the reader was visible to the producer may
+      // have overwritten the start of its replay, move it past them.
+      auto cursor = r->cursor_.load();
+      const auto start = oldest(tail_.load()) << 1;
+      while (cursor != closed && cursor < start &&
+          !r->cursor_.compare_exchange_weak(cursor, start)) {}
+      // the up-channel is valid until out receives done, error or stopping.
+      // the kicks that arrive meanwhile are picked up by this drain.
+      ::pushmi::set_starting(r->out_, r->up_);
+      auto keep = r->drain_(r);
+      r->unpin();
+    }
+
+    // the slot of seq is about to be overwritten. no reader may read it
+    // afterwards, and a reader that is reading it must be done first.
+    void reclaim(std::uint64_t seq) {
+      for (auto r = readers_.load(); r; r = r->next_) {
+        auto cursor = r->cursor_.load();
+        while (cursor != closed && (cursor >> 1) <= seq) {
+          if ((cursor & 1) || policy_ == overflow_policy::block) {
+            std::this_thread::yield();
+            cursor = r->cursor_.load();
+          } else if (policy_ == overflow_policy::drop_oldest) {
+            if (r->cursor_.compare_exchange_weak(cursor, (seq + 1) << 1)) {
+              break;
+            }
+          } else if (r->cursor_.compare_exchange_weak(cursor, closed)) {
+            r->overflowed_.store(true);
+            r->kick();
+            break;
+          }
+        }
+      }
+    }
+
+    // kicks every reader and frees the readers that have finished, so that
+    // the list only holds the readers that are still reading. only the
+    // producer unlinks readers and submit only pushes at the head, so a
+    // finished reader at the head, when a reader is being pushed, is left
+    // for a later kick_all.
+    void kick_all() {
+      reader* prev = nullptr;
+      for (auto r = readers_.load(); r;) {
+        r->kick();
+        auto next = r->next_;
+        if (r->reclaimable()) {
+          auto head = r;
+          if (prev) {
+            prev->next_ = next;
+            r->destroy_(r);
+            r = next;
+            continue;
+          }
+          if (readers_.compare_exchange_strong(head, next)) {
+            r->destroy_(r);
+            r = next;
+            continue;
+          }
+        }
+        prev = r;
+        r = next;
+      }
+    }
+
+    template <class V>
+    void value(V&& v) {
+      if (complete_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      const auto seq = tail_.load(std::memory_order_relaxed);
+      if (seq >= size_) {
+        reclaim(seq - size_);
+      }
+      slots_[seq % size_] = (V&&) v;
+      tail_.store(seq + 1);
+      kick_all();
+    }
+    PUSHMI_TEMPLATE(class E)
+      (requires SemiMovable<E>)
+    void error(E e) noexcept {
+      if (complete_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      ep_ = std::move(e);
+      complete_.store(true, std::memory_order_release);
+      kick_all();
+    }
+    void done() {
+      if (complete_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      complete_.store(true, std::memory_order_release);
+      kick_all();
+    }
+  };
+
+  struct replay_receiver {
+
+    using properties = property_set_insert_t<
+      property_set<is_receiver<>, is_many<>>, PS>;
+
+    std::shared_ptr<replay_shared> s;
+
+    PUSHMI_TEMPLATE(class V)
+      (requires ConvertibleTo<V, T>)
+    void value(V&& v) {
+      s->value((V&&) v);
+    }
+    PUSHMI_TEMPLATE(class E)
+      (requires SemiMovable<E>)
+    void error(E e) noexcept {
+      s->error(std::move(e));
+    }
+    void done() {
+      s->done();
+    }
+    // a flow producer is asked for everything, the ring and the overflow
+    // policy deal with receivers that fall behind.
+    template <class Up>
+    void starting(Up& up) {
+      ::pushmi::set_value(up, std::numeric_limits<std::ptrdiff_t>::max());
+    }
+    void stopping() noexcept {
+      s->done();
+    }
+  };
+
+  explicit replay_subject(
+      std::size_t capacity,
+      overflow_policy policy = overflow_policy::drop_oldest)
+    : s(make_shared(capacity, policy)) {}
+
+  // the subject and its receivers share s, which points into producers.
+  // the readers hold the replay_shared itself, and not s, so that a reader
+  // that is still reading does not keep the producers alive.
+  struct producers {
+    explicit producers(std::shared_ptr<replay_shared> s) : s_(std::move(s)) {}
+    ~producers() {
+      s_->done();
+    }
+    std::shared_ptr<replay_shared> s_;
+  };
+  static std::shared_ptr<replay_shared> make_shared(
+      std::size_t capacity, overflow_policy policy) {
+    auto p = std::make_shared<producers>(
+      std::make_shared<replay_shared>(capacity, policy));
+    return std::shared_ptr<replay_shared>(p, p->s_.get());
+  }
+
+  std::shared_ptr<replay_shared> s;
+
+  PUSHMI_TEMPLATE(class Out)
+    (requires Receiver<Out, is_flow<>>)
+  void submit(Out out) {
+    s->submit(std::move(out));
+  }
+
+  auto receiver() {
+    return replay_receiver{s};
+  }
+};
+
+} // namespace pushmi
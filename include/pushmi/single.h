@@ -6,6 +6,7 @@
 
 #include <future>
 #include "none.h"
+#include "detail/heap_fallback.h"
 
 namespace pushmi {
 
@@ -27,11 +28,13 @@ class single<V, E> {
     static void s_error(data&, E) noexcept { std::terminate(); }
     static void s_rvalue(data&, V&&) {}
     static void s_lvalue(data&, V&) {}
+    static stop_token s_stop(data&) { return {}; }
     void (*op_)(data&, data*) = vtable::s_op;
     void (*done_)(data&) = vtable::s_done;
     void (*error_)(data&, E) noexcept = vtable::s_error;
     void (*rvalue_)(data&, V&&) = vtable::s_rvalue;
     void (*lvalue_)(data&, V&) = vtable::s_lvalue;
+    stop_token (*stop_)(data&) = vtable::s_stop;
   };
   static constexpr vtable const noop_ {};
   vtable const* vptr_ = &noop_;
@@ -67,8 +70,13 @@ class single<V, E> {
       static void lvalue(data& src, V& v) {
         ::pushmi::set_value(*static_cast<Wrapped*>(src.pobj_), v);
       }
+      static stop_token stop(data& src) {
+        return ::pushmi::get_stop_token(*static_cast<Wrapped*>(src.pobj_));
+      }
     };
-    static const vtable vtbl{s::op, s::done, s::error, s::rvalue, s::lvalue};
+    static const vtable vtbl{
+        s::op, s::done, s::error, s::rvalue, s::lvalue, s::stop};
+    PUSHMI_HEAP_FALLBACK(single, Wrapped);
     data_.pobj_ = new Wrapped(std::move(obj));
     vptr_ = &vtbl;
   }
@@ -95,13 +103,18 @@ class single<V, E> {
       static void lvalue(data& src, V& v) {
         ::pushmi::set_value(*static_cast<Wrapped*>((void*)src.buffer_), v);
       }
+      static stop_token stop(data& src) {
+        return ::pushmi::get_stop_token(
+          *static_cast<Wrapped*>((void*)src.buffer_));
+      }
     };
-    static const vtable vtbl{s::op, s::done, s::error, s::rvalue, s::lvalue};
+    static const vtable vtbl{
+        s::op, s::done, s::error, s::rvalue, s::lvalue, s::stop};
     new ((void*)data_.buffer_) Wrapped(std::move(obj));
     vptr_ = &vtbl;
   }
 public:
-  using properties = property_set<is_receiver<>, is_single<>>;
+  using properties = property_set<is_receiver<>, is_single<>, is_stoppable<>>;
 
   single() = default;
   single(single&& that) noexcept : single() {
@@ -150,6 +163,9 @@ public:
       vptr_->done_(data_);
     }
   }
+  stop_token get_stop_token() {
+    return vptr_->stop_(data_);
+  }
 };
 
 // Class static definitions:
@@ -232,7 +248,9 @@ class single<Data, DVF, DEF, DDF> {
       "error function must be noexcept and support std::exception_ptr");
 
  public:
-  using properties = property_set<is_receiver<>, is_single<>>;
+  using properties = property_set_insert_t<
+      property_set<is_receiver<>, is_single<>>,
+      stop_properties_t<Data>>;
 
   constexpr explicit single(Data d)
       : single(std::move(d), DVF{}, DEF{}, DDF{}) {}
@@ -267,6 +285,9 @@ class single<Data, DVF, DEF, DDF> {
       df_(data_);
     }
   }
+  stop_token get_stop_token() {
+    return ::pushmi::get_stop_token(data_);
+  }
 };
 
 template <>
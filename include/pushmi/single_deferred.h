@@ -5,6 +5,7 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "single.h"
+#include "detail/heap_fallback.h"
 
 namespace pushmi {
 
@@ -40,6 +41,7 @@ class any_single_deferred {
       }
     };
     static const vtable vtbl{s::op, s::submit};
+    PUSHMI_HEAP_FALLBACK(any_single_deferred, Wrapped);
     data_.pobj_ = new Wrapped(std::move(obj));
     vptr_ = &vtbl;
   }
@@ -0,0 +1,114 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace pushmi {
+
+namespace detail {
+
+// the threads that wait on a stop token, until a deadline, park on one of a
+// few condition variables chosen by the address of the flag. a stop request
+// wakes the waiters of its bucket, and only takes the lock when there are
+// any, so that stopping a token that nobody waits on stays a single
+// exchange.
+struct stop_waiters {
+  std::mutex lock_;
+  std::condition_variable cv_;
+  std::atomic<int> waiting_{0};
+
+  static stop_waiters& of(const void* flag) {
+    static stop_waiters buckets[16];
+    return buckets[(reinterpret_cast<std::uintptr_t>(flag) >> 4) % 16];
+  }
+  void notify() {
+    // pairs with the fence in stop_token::wait_until, either the waiter
+    // sees the flag or the flag sees the waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_.load(std::memory_order_relaxed) != 0) {
+      { std::lock_guard<std::mutex> guard{lock_}; }
+      cv_.notify_all();
+    }
+  }
+};
+
+} // namespace detail
+
+// sets a flag that is handed out as a stop_token, and wakes the threads that
+// wait on that token. returns true for the call that made the request.
+inline bool request_stop(std::atomic<bool>& stopped) noexcept {
+  if (stopped.exchange(true, std::memory_order_acq_rel)) {
+    return false;
+  }
+  detail::stop_waiters::of(&stopped).notify();
+  return true;
+}
+
+// a stop_token tells a sender that the receiver it is working for no longer
+// needs the result. senders poll it; a default constructed token never
+// stops. the flag is shared, so a token can be held past the lifetime of
+// the receiver that handed it out.
+class stop_token {
+  std::shared_ptr<const std::atomic<bool>> stopped_;
+public:
+  stop_token() = default;
+  explicit stop_token(std::shared_ptr<const std::atomic<bool>> stopped)
+    : stopped_(std::move(stopped)) {}
+
+  bool stop_possible() const noexcept {
+    return !!stopped_;
+  }
+  bool stop_requested() const noexcept {
+    return !!stopped_ && stopped_->load(std::memory_order_acquire);
+  }
+
+  // blocks until when, or until a stop is requested with request_stop,
+  // whichever comes first. returns stop_requested().
+  template <class Clock, class Duration>
+  bool wait_until(const std::chrono::time_point<Clock, Duration>& when) const {
+    if (!stopped_) {
+      std::this_thread::sleep_until(when);
+      return false;
+    }
+    auto& waiters = detail::stop_waiters::of(stopped_.get());
+    std::unique_lock<std::mutex> guard{waiters.lock_};
+    waiters.waiting_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!stop_requested() &&
+        waiters.cv_.wait_until(guard, when) != std::cv_status::timeout) {}
+    waiters.waiting_.fetch_sub(1, std::memory_order_relaxed);
+    return stop_requested();
+  }
+};
+
+// a stop_source owns the flag. the flag can also live inside some other
+// shared state, using the aliasing shared_ptr constructor.
+class stop_source {
+  std::shared_ptr<std::atomic<bool>> stopped_;
+public:
+  stop_source() : stopped_(std::make_shared<std::atomic<bool>>(false)) {}
+  explicit stop_source(std::shared_ptr<std::atomic<bool>> stopped)
+    : stopped_(std::move(stopped)) {}
+
+  stop_token get_token() const {
+    return stop_token{stopped_};
+  }
+  // returns true for the call that made the request.
+  bool request_stop() noexcept {
+    return ::pushmi::request_stop(*stopped_);
+  }
+  bool stop_requested() const noexcept {
+    return stopped_->load(std::memory_order_acquire);
+  }
+};
+
+} // namespace pushmi
@@ -5,7 +5,7 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
-#include <vector>
+#include <atomic>
 
 #include <pushmi/time_single_deferred.h>
 
@@ -19,42 +19,116 @@ struct subject<T, PS> {
 
   using properties = property_set_insert_t<property_set<is_sender<>, is_single<>>, PS>;
 
+  // the receivers that wait for the subject are pushed on an intrusive
+  // stack without a lock. the one signal that completes the subject stores
+  // its outcome and then closes the stack with a single exchange, so a
+  // receiver that finds the stack closed reads an outcome that no longer
+  // changes. the value is stored once and every receiver gets it by const
+  // reference.
   struct subject_shared {
-    bool done_ = false;
+    // a waiter is signaled with the outcome of the subject, or discarded
+    // without a signal when it is given no subject.
+    struct waiter {
+      waiter* next_;
+      void (*signal_)(waiter*, subject_shared*);
+    };
+    template <class Out>
+    struct waiter_for : waiter {
+      explicit waiter_for(Out out)
+        : waiter{nullptr, &waiter_for::signal}, out_(std::move(out)) {}
+      Out out_;
+      static void signal(waiter* w, subject_shared* s) {
+        std::unique_ptr<waiter_for> self{static_cast<waiter_for*>(w)};
+        if (s) {
+          s->deliver(self->out_);
+        }
+      }
+    };
+
+    std::atomic<waiter*> waiters_{nullptr};
+    std::atomic_flag completing_ = ATOMIC_FLAG_INIT;
     pushmi::detail::opt<T> t_;
     std::exception_ptr ep_;
-    std::vector<any_single<T>> receivers_;
-    std::mutex lock_;
+
+    ~subject_shared() {
+      auto head = waiters_.load(std::memory_order_relaxed);
+      while (head && head != closed()) {
+        auto w = std::exchange(head, head->next_);
+        w->signal_(w, nullptr);
+      }
+    }
+
+    waiter* closed() noexcept {
+      return reinterpret_cast<waiter*>(this);
+    }
+
+    template <class Out>
+    void deliver(Out& out) {
+      if (ep_) {::pushmi::set_error(out, ep_); return;}
+      if (!!t_) {::pushmi::set_value(out, (const T&) *t_); return;}
+      ::pushmi::set_done(out);
+    }
+
     PUSHMI_TEMPLATE(class Out)
       (requires Receiver<Out>)
     void submit(Out out) {
-      std::unique_lock<std::mutex> guard(lock_);
-      if (ep_) {::pushmi::set_error(out, ep_); return;}
-      if (!!t_) {::pushmi::set_value(out, (const T&)t_); return;}
-      if (done_) {::pushmi::set_done(out); return;}
-      receivers_.push_back(any_single<T>{out});
+      auto head = waiters_.load(std::memory_order_acquire);
+      if (head == closed()) {
+        deliver(out);
+        return;
+      }
+      std::unique_ptr<waiter_for<Out>> w{new waiter_for<Out>{std::move(out)}};
+      w->next_ = head;
+      while (!waiters_.compare_exchange_weak(
+          w->next_, w.get(),
+          std::memory_order_release, std::memory_order_acquire)) {
+        if (w->next_ == closed()) {
+          deliver(w->out_);
+          return;
+        }
+      }
+      w.release();
+    }
+
+    // only the first signal completes the subject. the stack holds the
+    // receivers newest first, they are signaled in the order that they were
+    // submitted.
+    bool claim() noexcept {
+      return !completing_.test_and_set(std::memory_order_relaxed);
+    }
+    void complete() {
+      auto head = waiters_.exchange(closed(), std::memory_order_acq_rel);
+      waiter* ordered = nullptr;
+      while (head) {
+        auto next = std::exchange(head->next_, ordered);
+        ordered = std::exchange(head, next);
+      }
+      while (ordered) {
+        auto w = std::exchange(ordered, ordered->next_);
+        w->signal_(w, this);
+      }
     }
+
     PUSHMI_TEMPLATE(class V)
-      (requires SemiMovable<V>)
+      (requires ConvertibleTo<V, T>)
     void value(V&& v) {
-      std::unique_lock<std::mutex> guard(lock_);
-      t_ = detail::as_const(v);
-      for (auto& out : receivers_) {::pushmi::set_value(out, (V&&) v);}
-      receivers_.clear();
+      if (claim()) {
+        t_ = (V&&) v;
+        complete();
+      }
     }
     PUSHMI_TEMPLATE(class E)
       (requires SemiMovable<E>)
     void error(E e) noexcept {
-      std::unique_lock<std::mutex> guard(lock_);
-      ep_ = e;
-      for (auto& out : receivers_) {::pushmi::set_error(out, std::move(e));}
-      receivers_.clear();
+      if (claim()) {
+        ep_ = std::move(e);
+        complete();
+      }
     }
     void done() {
-      std::unique_lock<std::mutex> guard(lock_);
-      done_ = true;
-      for (auto& out : receivers_) {::pushmi::set_done(out);}
-      receivers_.clear();
+      if (claim()) {
+        complete();
+      }
     }
   };
 
@@ -66,7 +140,7 @@ struct subject<T, PS> {
     std::shared_ptr<subject_shared> s;
 
     PUSHMI_TEMPLATE(class V)
-      (requires SemiMovable<V>)
+      (requires ConvertibleTo<V, T>)
     void value(V&& v) {
       s->value((V&&) v);
     }
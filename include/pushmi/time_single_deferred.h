@@ -5,6 +5,7 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "single.h"
+#include "detail/heap_fallback.h"
 
 namespace pushmi {
 
@@ -52,6 +53,7 @@ class any_time_single_deferred {
       }
     };
     static const vtable vtbl{s::op, s::now, s::submit};
+    PUSHMI_HEAP_FALLBACK(any_time_single_deferred, Wrapped);
     data_.pobj_ = new Wrapped(std::move(obj));
     vptr_ = &vtbl;
   }
@@ -137,6 +139,9 @@ class time_single_deferred<SF, NF> {
   auto now() {
     return nf_();
   }
+  bool is_current() {
+    return ::pushmi::is_current(sf_);
+  }
   PUSHMI_TEMPLATE(class TP, class Out)
     (requires Regular<TP> && Receiver<Out, is_single<>> &&
       Invocable<SF&, TP, Out>)
@@ -166,6 +171,9 @@ class time_single_deferred_2 {
   auto now() {
     return nf_(data_);
   }
+  bool is_current() {
+    return ::pushmi::is_current(data_);
+  }
   PUSHMI_TEMPLATE(class TP, class Out)
     (requires Regular<TP> && Receiver<Out, is_single<>> &&
       Invocable<DSF&, Data&, TP, Out>)
@@ -74,7 +74,10 @@ PUSHMI_CONCEPT_DEF(
 PUSHMI_CONCEPT_DEF(
   template(class T, template<class...> class C)
   (concept Valid)(T, C),
-    True< C<T> >
+    // C<T> is named in an expression, so that native concepts substitute it
+    requires () (
+      (std::add_pointer_t<C<T>>) nullptr
+    )
 );
 
 PUSHMI_CONCEPT_DEF(
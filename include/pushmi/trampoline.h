@@ -4,9 +4,8 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
-#include <algorithm>
 #include <chrono>
-#include <deque>
+#include <map>
 #include <thread>
 #include "executor.h"
 #include "time_single_deferred.h"
@@ -14,7 +13,7 @@
 namespace pushmi {
 
 struct recurse_t {};
-constexpr const recurse_t recurse{};
+PUSHMI_INLINE_VAR constexpr const recurse_t recurse{};
 
 struct _pipeable_sender_ {};
 
@@ -47,6 +46,10 @@ class delegator : _pipeable_sender_ {
     return trampoline<E>::now();
   }
 
+  bool is_current() {
+    return trampoline<E>::is_owned();
+  }
+
   PUSHMI_TEMPLATE (class SingleReceiver)
     (requires Receiver<remove_cvref_t<SingleReceiver>, is_single<>>)
   void submit(time_point when, SingleReceiver&& what) {
@@ -66,6 +69,10 @@ class nester : _pipeable_sender_ {
     return trampoline<E>::now();
   }
 
+  bool is_current() {
+    return trampoline<E>::is_owned();
+  }
+
   template <class SingleReceiver>
   void submit(time_point when, SingleReceiver&& what) {
     trampoline<E>::submit(ownornest, when, std::forward<SingleReceiver>(what));
@@ -81,7 +88,10 @@ class trampoline {
   using error_type = std::decay_t<E>;
   using work_type =
      any_single<any_time_executor_ref<error_type, time_point>, error_type>;
-  using queue_type = std::deque<std::tuple<time_point, work_type>>;
+  // the deferred work, ordered by time and then by submission. an entry is
+  // only erased by the thread that owns the queue, so an iterator to it is
+  // a stable handle for as long as it waits.
+  using queue_type = std::multimap<time_point, work_type>;
   using pending_type = std::tuple<int, queue_type, time_point>;
 
   inline static pending_type*& owner() {
@@ -134,8 +144,9 @@ class trampoline {
       try {
         if (++depth(*owner()) > 100 || awhen > trampoline<E>::now()) {
           // defer work to owner
-          pending(*owner()).push_back(
-              std::make_tuple(awhen, work_type{std::move(awhat)}));
+          pending(*owner()).emplace(awhen, work_type{std::move(awhat)});
+        } else if (::pushmi::get_stop_token(awhat).stop_requested()) {
+          ::pushmi::set_done(awhat);
         } else {
           // dynamic recursion - optimization to balance queueing and
           // stack usage and value interleaving on the same thread.
@@ -163,8 +174,7 @@ class trampoline {
       try {
         ::pushmi::set_error(awhat, std::current_exception());
         for (auto& item : pending(pending_store)) {
-          auto& what = std::get<1>(item);
-          ::pushmi::set_error(what, std::current_exception());
+          ::pushmi::set_error(item.second, std::current_exception());
         }
       } catch (...) {
       }
@@ -197,35 +207,50 @@ class trampoline {
       auto when = awhen;
       while (when != time_point{}) {
         if (when > trampoline<E>::now()) {
-          std::this_thread::sleep_until(when);
+          // a stop request wakes the wait, so a timer that is no longer
+          // needed frees the thread, and whatever the work holds, long
+          // before its deadline.
+          ::pushmi::get_stop_token(awhat).wait_until(when);
+        }
+        // work whose receiver no longer needs it is completed with done
+        if (::pushmi::get_stop_token(awhat).stop_requested()) {
+          ::pushmi::set_done(awhat);
+          break;
         }
         next(pending_store) = time_point{};
         ::pushmi::set_value(awhat, that);
         when = next(pending_store);
       }
     } else {
-      // ensure work is sorted by time
-      pending(pending_store)
-          .push_back(std::make_tuple(awhen, work_type{std::move(awhat)}));
+      // the queue keeps the work sorted by time
+      pending(pending_store).emplace(awhen, work_type{std::move(awhat)});
     }
 
     if (pending(pending_store).empty()) {
       return;
     }
 
-    while (!pending(pending_store).empty()) {
-      std::stable_sort(
-          pending(pending_store).begin(),
-          pending(pending_store).end(),
-          [](auto& lhs, auto& rhs) {
-            auto& lwhen = std::get<0>(lhs);
-            auto& rwhen = std::get<0>(rhs);
-            return lwhen < rwhen;
-          });
-      auto item = std::move(pending(pending_store).front());
-      pending(pending_store).pop_front();
-      auto& when = std::get<0>(item);
-      auto& what = std::get<1>(item);
+    auto& queue = pending(pending_store);
+    while (!queue.empty()) {
+      auto front = queue.begin();
+      // work whose receiver no longer needs it is completed with done, and
+      // erased, once it is at the front, without waiting for its time.
+      if (::pushmi::get_stop_token(front->second).stop_requested()) {
+        auto what = std::move(front->second);
+        queue.erase(front);
+        ::pushmi::set_done(what);
+        continue;
+      }
+      // only this thread adds work to the queue, so nothing can come due
+      // before the front while it waits. a stop request for the front ends
+      // the wait early.
+      const auto when = front->first;
+      if (when > trampoline<E>::now()) {
+        ::pushmi::get_stop_token(front->second).wait_until(when);
+        continue;
+      }
+      auto what = std::move(front->second);
+      queue.erase(front);
       any_time_executor_ref<error_type, time_point> anythis{that};
       ::pushmi::set_value(what, anythis);
     }
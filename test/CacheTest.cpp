@@ -0,0 +1,157 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+using namespace std::literals;
+
+#include "pushmi/o/just.h"
+#include "pushmi/o/transform.h"
+#include "pushmi/o/cache.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/extension_operators.h"
+
+#include "pushmi/time_single_deferred.h"
+#include "pushmi/new_thread.h"
+#include "pushmi/trampoline.h"
+
+#include "manual_time.h"
+
+using namespace pushmi::aliases;
+
+SCENARIO( "cache delivers stored values until they expire", "[cache]" ) {
+
+  GIVEN( "An upstream that counts its submits behind a cache with a ttl of 10ms" ) {
+    pushmi_test::manual_time clock;
+    auto submits = std::make_shared<int>(0);
+    auto lookup = v::make_single_deferred([submits](auto out) {
+      ::pushmi::set_value(out, "value " + std::to_string(++*submits));
+    });
+    std::string key = "config";
+    auto cached = op::cache<std::string>(
+      [&key] { return key; }, 10ms, clock.executor());
+
+    WHEN( "it is submitted twice" ) {
+      auto first = lookup | cached | op::get<std::string>;
+      auto second = lookup | cached | op::get<std::string>;
+
+      THEN( "the second submit is served from the cache" ) {
+        REQUIRE( first == "value 1" );
+        REQUIRE( second == "value 1" );
+        REQUIRE( *submits == 1 );
+        REQUIRE( clock.submitted() == 0 );
+      }
+    }
+
+    WHEN( "the keys differ" ) {
+      auto first = lookup | cached | op::get<std::string>;
+      key = "auth";
+      auto second = lookup | cached | op::get<std::string>;
+
+      THEN( "each key runs the upstream" ) {
+        REQUIRE( first == "value 1" );
+        REQUIRE( second == "value 2" );
+        REQUIRE( *submits == 2 );
+      }
+    }
+
+    WHEN( "the ttl has passed" ) {
+      lookup | cached | op::get<std::string>;
+      clock.advance(10ms);
+      auto again = lookup | cached | op::get<std::string>;
+
+      THEN( "the entry was expired and the upstream runs again" ) {
+        REQUIRE( again == "value 2" );
+        REQUIRE( *submits == 2 );
+      }
+    }
+
+    WHEN( "an entry is replaced after it expired" ) {
+      lookup | cached | op::get<std::string>;
+      clock.advance(10ms);
+      lookup | cached | op::get<std::string>;
+      clock.advance(5ms);
+      auto again = lookup | cached | op::get<std::string>;
+
+      THEN( "the newer entry is kept for its own ttl" ) {
+        REQUIRE( again == "value 2" );
+        REQUIRE( *submits == 2 );
+      }
+    }
+  }
+
+  GIVEN( "A cache of values that are never looked up again" ) {
+    pushmi_test::manual_time clock;
+    auto key = std::make_shared<int>(0);
+    auto cached = op::cache<std::shared_ptr<int>>(
+      [key] { return *key; }, 10ms, clock.executor());
+    auto alive = std::make_shared<int>(0);
+    std::weak_ptr<int> watch = alive;
+    op::just(std::move(alive)) | cached | op::submit();
+
+    WHEN( "the ttl has passed and other keys are stored" ) {
+      clock.advance(10ms);
+      // enough keys to store into every shard
+      for (*key = 1; *key <= 64; ++*key) {
+        op::just(std::make_shared<int>(0)) | cached | op::submit();
+      }
+
+      THEN( "the expired entry is swept out" ) {
+        REQUIRE( watch.expired() );
+      }
+    }
+  }
+
+  GIVEN( "An upstream that fails" ) {
+    pushmi_test::manual_time clock;
+    auto submits = std::make_shared<int>(0);
+    auto failing = v::make_single_deferred([submits](auto out) {
+      ++*submits;
+      ::pushmi::set_error(out, std::make_exception_ptr(std::runtime_error("down")));
+    });
+    auto cached = op::cache<int>([] { return 1; }, 10ms, clock.executor());
+
+    WHEN( "it is submitted twice" ) {
+      int errors = 0;
+      for (int i = 0; i < 2; ++i) {
+        failing | cached | op::submit([](int) {}, [&](auto) noexcept { ++errors; });
+      }
+
+      THEN( "errors are not cached" ) {
+        REQUIRE( errors == 2 );
+        REQUIRE( *submits == 2 );
+        REQUIRE( clock.submitted() == 0 );
+      }
+    }
+  }
+
+  GIVEN( "A cache with a ttl of 2s on a real time executor" ) {
+
+    WHEN( "a value is looked up on the trampoline" ) {
+      auto cached = op::cache<int>([] { return 1; }, 2s, mi::trampoline());
+      auto start = std::chrono::steady_clock::now();
+      auto miss = op::just(5) | cached | op::get<int>;
+      auto hit = op::just(6) | cached | op::get<int>;
+      auto elapsed = std::chrono::steady_clock::now() - start;
+
+      THEN( "the miss is not held until the entry expires" ) {
+        REQUIRE( miss == 5 );
+        REQUIRE( hit == 5 );
+        REQUIRE( elapsed < 1s );
+      }
+    }
+
+    WHEN( "a value is looked up on new_thread" ) {
+      auto cached = op::cache<int>([] { return 1; }, 2s, mi::new_thread());
+      auto start = std::chrono::steady_clock::now();
+      auto miss = mi::new_thread() | op::transform([](auto) { return 5; }) |
+        cached | op::get<int>;
+      auto elapsed = std::chrono::steady_clock::now() - start;
+
+      THEN( "the miss is delivered right away" ) {
+        REQUIRE( miss == 5 );
+        REQUIRE( elapsed < 1s );
+      }
+    }
+  }
+}
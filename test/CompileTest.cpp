@@ -324,3 +324,90 @@ void flow_single_deferred_test(){
 
   auto any0 = pushmi::any_flow_single_deferred<int>(in0);
 }
+
+void many_test() {
+  auto out0 = pushmi::MAKE(many)();
+  auto out1 = pushmi::MAKE(many)(pushmi::ignoreVF{});
+  auto out2 = pushmi::MAKE(many)(pushmi::ignoreVF{}, pushmi::abortEF{});
+  auto out3 =
+      pushmi::MAKE(many)(pushmi::ignoreVF{}, pushmi::abortEF{}, pushmi::ignoreDF{});
+  auto out4 = pushmi::MAKE(many)([](auto v) { v.get(); });
+  auto out5 = pushmi::MAKE(many)(
+      pushmi::on_value([](auto v) { v.get(); }, [](int v) {}),
+      pushmi::on_error(
+        [](std::exception_ptr e) noexcept {},
+        [](auto e)noexcept { e.get(); }
+      ));
+  auto out6 = pushmi::MAKE(many)(
+      pushmi::on_done([]() {  }));
+
+  using Out0 = decltype(out0);
+
+  auto proxy0 = pushmi::MAKE(many)(out0);
+  auto proxy1 = pushmi::MAKE(many)(out0, pushmi::passDVF{});
+  auto proxy2 = pushmi::MAKE(many)(out0, [](auto d, auto v) {
+    pushmi::set_value(d, v.get());
+  });
+  auto proxy3 = pushmi::MAKE(many)(
+      out0,
+      pushmi::on_done([](Out0&) { }));
+
+  auto any0 = pushmi::any_many<int>(out0);
+  auto any1 = pushmi::any_many<int>(proxy0);
+  any0.value(0);
+  any0.value(1);
+  any0.done();
+}
+
+void flow_many_test() {
+  auto out0 = pushmi::MAKE(flow_many)();
+  auto out1 = pushmi::MAKE(flow_many)(pushmi::ignoreVF{});
+  auto out2 = pushmi::MAKE(flow_many)(pushmi::ignoreVF{}, pushmi::abortEF{});
+  auto out3 =
+      pushmi::MAKE(flow_many)(
+          pushmi::ignoreVF{},
+          pushmi::abortEF{},
+          pushmi::ignoreDF{},
+          pushmi::ignoreStpF{},
+          pushmi::ignoreStrtF{});
+
+  using Out0 = decltype(out0);
+
+  auto proxy0 = pushmi::MAKE(flow_many)(out0);
+  auto proxy1 = pushmi::MAKE(flow_many)(out0, pushmi::passDVF{});
+  auto proxy2 = pushmi::MAKE(flow_many)(out0,
+    pushmi::passDVF{},
+    pushmi::passDEF{},
+    pushmi::passDDF{},
+    pushmi::passDStpF{},
+    pushmi::passDStrtF{});
+
+  auto any2 = pushmi::any_flow_many<int>(out0);
+  auto any3 = pushmi::any_flow_many<int>(proxy0);
+}
+
+void flow_many_deferred_test(){
+  auto in0 = pushmi::MAKE(flow_many_deferred)();
+  auto in1 = pushmi::MAKE(flow_many_deferred)(pushmi::ignoreSF{});
+  auto in3 = pushmi::MAKE(flow_many_deferred)([&](auto out){
+    in0.submit(pushmi::MAKE(flow_many)(std::move(out),
+      pushmi::on_value([](auto d, int v){ pushmi::set_value(d, v); })
+    ));
+  });
+
+  auto out0 = pushmi::MAKE(flow_many)();
+  auto out1 = pushmi::MAKE(flow_many)(out0, pushmi::on_value([](auto d, int v){
+    pushmi::set_value(d, v);
+  }));
+  in3.submit(out1);
+
+  auto any0 = pushmi::any_flow_many_deferred<int>(in0);
+
+  int values[] = {0, 1, 2};
+  auto in4 = op::flow_from(values, values + 3);
+  auto in5 = pushmi::MAKE(flow_single_deferred)([](auto out){
+    pushmi::set_value(out, 42);
+  }) | op::as_flow_many();
+  auto any1 = pushmi::any_flow_many_deferred<int>(in4);
+  auto any2 = pushmi::any_flow_many_deferred<int>(in5);
+}
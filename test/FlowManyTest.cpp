@@ -0,0 +1,188 @@
+#include "catch.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "pushmi/flow_single_deferred.h"
+#include "pushmi/flow_many_deferred.h"
+#include "pushmi/o/flow_from.h"
+#include "pushmi/o/as_flow_many.h"
+#include "pushmi/o/extension_operators.h"
+
+using namespace pushmi::aliases;
+
+SCENARIO( "flow_from only emits values that were requested", "[flow_many][flow_from]" ) {
+
+  GIVEN( "A flow_many sender over five ints" ) {
+    std::vector<int> source{1, 2, 3, 4, 5};
+    auto f = op::flow_from(source.begin(), source.end());
+    using F = decltype(f);
+
+    REQUIRE( v::SenderTo<F, v::any_flow_many<int>, v::is_many<>, v::is_flow<>> );
+
+    std::vector<int> values;
+    int signals = 0;
+    v::any_many<std::ptrdiff_t>* up = nullptr;
+
+    WHEN( "two values are requested" ) {
+      f.submit(v::make_flow_many(
+        [&](int v) { values.push_back(v); },
+        [&](auto e) noexcept { signals += 100; },
+        [&]() { signals += 10; },
+        [&]() noexcept { signals += 1; },
+        [&](v::any_many<std::ptrdiff_t>& u) { up = &u; ::pushmi::set_value(u, 2); }));
+
+      THEN( "only two values are delivered and the flow is still open" ) {
+        REQUIRE( values == std::vector<int>{1, 2} );
+        REQUIRE( signals == 0 );
+        // the producer keeps itself alive until it is cancelled
+        ::pushmi::set_done(*up);
+      }
+
+      WHEN( "the remaining credit is requested" ) {
+        ::pushmi::set_value(*up, 10);
+
+        THEN( "the rest of the values and done are delivered" ) {
+          REQUIRE( values == source );
+          REQUIRE( signals == 10 );
+        }
+      }
+
+      WHEN( "the flow is cancelled" ) {
+        ::pushmi::set_done(*up);
+
+        THEN( "no more values are delivered and stopping is signalled" ) {
+          REQUIRE( values == std::vector<int>{1, 2} );
+          REQUIRE( signals == 1 );
+        }
+      }
+    }
+
+    WHEN( "one value is requested from each value" ) {
+      f.submit(v::make_flow_many(
+        [&](int v) { values.push_back(v); ::pushmi::set_value(*up, 1); },
+        [&](auto e) noexcept { signals += 100; },
+        [&]() { signals += 10; },
+        [&]() noexcept { signals += 1; },
+        [&](v::any_many<std::ptrdiff_t>& u) { up = &u; ::pushmi::set_value(u, 1); }));
+
+      THEN( "all values are delivered in order followed by done" ) {
+        REQUIRE( values == source );
+        REQUIRE( signals == 10 );
+      }
+    }
+
+    WHEN( "the receiver throws from a value" ) {
+      f.submit(v::make_flow_many(
+        [&](int v) {
+          values.push_back(v);
+          if (v == 2) {
+            throw std::runtime_error("value");
+          }
+        },
+        [&](auto e) noexcept { signals += 100; },
+        [&]() { signals += 10; },
+        [&]() noexcept { signals += 1; },
+        [&](v::any_many<std::ptrdiff_t>& u) { up = &u; ::pushmi::set_value(u, 5); }));
+
+      THEN( "the flow ends with the error and stopping" ) {
+        REQUIRE( values == std::vector<int>{1, 2} );
+        REQUIRE( signals == 101 );
+      }
+    }
+  }
+}
+
+SCENARIO( "as_flow_many adapts a flow_single sender", "[flow_many][as_flow_many]" ) {
+
+  GIVEN( "A flow_single sender adapted to flow_many" ) {
+    int submits = 0;
+    auto f = v::make_flow_single_deferred([&](auto out) {
+      ++submits;
+      auto up = v::make_none();
+      ::pushmi::set_starting(out, up);
+      ::pushmi::set_value(out, 42);
+    }) | op::as_flow_many();
+    using F = decltype(f);
+
+    REQUIRE( v::SenderTo<F, v::any_flow_many<int>, v::is_many<>, v::is_flow<>> );
+
+    std::vector<int> values;
+    int signals = 0;
+    v::any_many<std::ptrdiff_t>* up = nullptr;
+    auto out = v::make_flow_many(
+      [&](int v) { values.push_back(v); },
+      [&](auto e) noexcept { signals += 100; },
+      [&]() { signals += 10; },
+      [&]() noexcept { signals += 1; },
+      [&](v::any_many<std::ptrdiff_t>& u) { up = &u; });
+
+    WHEN( "the receiver has not requested a value" ) {
+      f.submit(out);
+
+      THEN( "the upstream sender has not been submitted" ) {
+        REQUIRE( submits == 0 );
+        REQUIRE( values.empty() );
+        ::pushmi::set_done(*up);
+      }
+
+      WHEN( "a value is requested" ) {
+        ::pushmi::set_value(*up, 1);
+
+        THEN( "the value and done are delivered" ) {
+          REQUIRE( submits == 1 );
+          REQUIRE( values == std::vector<int>{42} );
+          REQUIRE( signals == 10 );
+        }
+      }
+
+      WHEN( "the flow is cancelled before any request" ) {
+        ::pushmi::set_done(*up);
+
+        THEN( "the upstream sender is never submitted" ) {
+          REQUIRE( submits == 0 );
+          REQUIRE( signals == 1 );
+        }
+      }
+    }
+  }
+
+  GIVEN( "A flow_single sender that only completes once it is cancelled" ) {
+    int submits = 0;
+    int cancels = 0;
+    std::shared_ptr<void> upstream;
+    auto f = v::make_flow_single_deferred([&](auto out) {
+      ++submits;
+      auto none = v::make_none([&cancels, out]() mutable {
+        ++cancels;
+        ::pushmi::set_stopping(out);
+      });
+      auto up = std::make_shared<decltype(none)>(std::move(none));
+      upstream = up;
+      ::pushmi::set_starting(out, *up);
+    }) | op::as_flow_many();
+
+    std::vector<int> values;
+    int signals = 0;
+    v::any_many<std::ptrdiff_t>* up = nullptr;
+    f.submit(v::make_flow_many(
+      [&](int v) { values.push_back(v); },
+      [&](auto e) noexcept { signals += 100; },
+      [&]() { signals += 10; },
+      [&]() noexcept { signals += 1; },
+      [&](v::any_many<std::ptrdiff_t>& u) { up = &u; ::pushmi::set_value(u, 1); }));
+
+    WHEN( "the flow is cancelled after the upstream was submitted" ) {
+      REQUIRE( submits == 1 );
+      ::pushmi::set_done(*up);
+
+      THEN( "the upstream is cancelled and the receiver sees stopping" ) {
+        REQUIRE( cancels == 1 );
+        REQUIRE( values.empty() );
+        REQUIRE( signals == 1 );
+      }
+    }
+    upstream.reset();
+  }
+}
@@ -0,0 +1,108 @@
+#include "catch.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "pushmi/o/filter.h"
+#include "pushmi/o/tap.h"
+#include "pushmi/o/transform.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/extension_operators.h"
+
+using namespace pushmi::aliases;
+
+namespace {
+
+// a single sender that remembers the size of the receiver it was given.
+auto source(int value, std::shared_ptr<std::size_t> size) {
+  return v::make_single_deferred([value, size](auto out) {
+    *size = sizeof(out);
+    ::pushmi::set_value(out, value);
+  });
+}
+
+} // namespace
+
+SCENARIO( "adjacent transform, filter and tap are fused into one receiver", "[fusion]" ) {
+
+  GIVEN( "A single sender" ) {
+    auto size = std::make_shared<std::size_t>(0);
+    std::vector<std::string> signals;
+    auto record = [&](std::string prefix) {
+      return v::on_value([&signals, prefix](auto v) {
+          signals.push_back(prefix + std::to_string(v));
+        });
+    };
+
+    WHEN( "a chain of operators is submitted" ) {
+      std::string result;
+      source(1, size) |
+        op::transform([](int v) { return v + 1; }) |
+        op::tap(record("tap ")) |
+        op::filter([](int v) { return v > 1; }) |
+        op::transform([](int v) { return std::to_string(v * 10); }) |
+        op::submit([&](std::string v) { result = v; });
+
+      THEN( "the stages run in order" ) {
+        REQUIRE( result == "20" );
+        REQUIRE( signals == std::vector<std::string>{"tap 2"} );
+      }
+    }
+
+    WHEN( "more stateless operators are added to a chain" ) {
+      int result = 0;
+      auto out = [&](int v) { result = v; };
+      source(1, size) |
+        op::transform([](int v) { return v + 1; }) |
+        op::submit(out);
+      const auto one = *size;
+
+      source(1, size) |
+        op::transform([](int v) { return v + 1; }) |
+        op::filter([](int v) { return v > 1; }) |
+        op::transform([](int v) { return v * 10; }) |
+        op::filter([](int v) { return v > 10; }) |
+        op::submit(out);
+      const auto four = *size;
+
+      THEN( "the receiver that in is given does not grow" ) {
+        REQUIRE( result == 20 );
+        REQUIRE( four == one );
+      }
+    }
+
+    WHEN( "the filter rejects the value" ) {
+      bool done = false;
+      source(1, size) |
+        op::tap(record("before ")) |
+        op::filter([](int) { return false; }) |
+        op::tap(v::on_done([&] { signals.push_back("after done"); })) |
+        op::submit(
+          v::on_value([&](int) { signals.push_back("value"); }),
+          v::on_error([](auto) noexcept {}),
+          v::on_done([&] { done = true; }));
+
+      THEN( "only the stages after the filter are done" ) {
+        REQUIRE( done );
+        REQUIRE( signals == std::vector<std::string>{"before 1", "after done"} );
+      }
+    }
+
+    WHEN( "a transform throws" ) {
+      bool error = false;
+      source(1, size) |
+        op::tap(record("before "),
+          v::on_error([&](auto) noexcept { signals.push_back("before error"); })) |
+        op::transform([](int) -> int { throw std::logic_error("bad"); }) |
+        op::tap(v::on_error([&](auto) noexcept { signals.push_back("after error"); })) |
+        op::submit(v::on_error([&](auto) noexcept { error = true; }));
+
+      THEN( "the error goes to the stages after the transform" ) {
+        REQUIRE( error );
+        REQUIRE( signals == std::vector<std::string>{"before 1", "after error"} );
+      }
+    }
+  }
+}
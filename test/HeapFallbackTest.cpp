@@ -0,0 +1,79 @@
+// the wrapped types that are counted here are local to this file, so the
+// other tests, that are built without the counting, do not share any of
+// the constructors that it changes.
+#define PUSHMI_COUNT_HEAP_FALLBACKS 1
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <typeinfo>
+
+#include "pushmi/o/just.h"
+#include "pushmi/o/submit.h"
+
+using namespace pushmi::aliases;
+
+namespace {
+
+struct small_receiver {
+  int* value;
+  void operator()(int v) { *value = v; }
+};
+
+struct large_receiver {
+  int* value;
+  std::array<char, 256> padding;
+  void operator()(int v) { *value = v; }
+};
+
+std::uint64_t fallbacks_of(const std::type_info& type) {
+  std::uint64_t count = 0;
+  for (auto& f : pushmi::heap_fallbacks()) {
+    if (std::strcmp(f.type, type.name()) == 0) {
+      count += f.count;
+    }
+  }
+  return count;
+}
+
+} // namespace
+
+SCENARIO( "heap fallbacks of the type erased wrappers are counted", "[heap_fallback]" ) {
+
+  GIVEN( "A small and a large receiver" ) {
+    pushmi::reset_heap_fallbacks();
+    int value = 0;
+    auto small = mi::make_single(small_receiver{&value});
+    auto large = mi::make_single(large_receiver{&value, {}});
+
+    WHEN( "they are wrapped in any_single" ) {
+      pushmi::any_single<int> s0{small};
+      pushmi::any_single<int> l0{large};
+      pushmi::any_single<int> l1{large};
+      op::just(42) | op::submit(std::move(l0));
+      const auto smallCount = fallbacks_of(typeid(small));
+      const auto largeCount = fallbacks_of(typeid(large));
+      const auto bySize = pushmi::heap_fallbacks_by_size();
+
+      THEN( "only the receiver that does not fit is counted" ) {
+        REQUIRE( value == 42 );
+        REQUIRE( smallCount == 0 );
+        REQUIRE( largeCount == 2 );
+        REQUIRE( std::any_of(bySize.begin(), bySize.end(), [&](auto& s) {
+          return s.first == sizeof(large) && s.second >= 2; }) );
+      }
+    }
+
+    WHEN( "the counts are reset" ) {
+      pushmi::any_none<> n0{large};
+      pushmi::reset_heap_fallbacks();
+      const auto largeCount = fallbacks_of(typeid(large));
+
+      THEN( "the wrapped type is reported with a count of 0" ) {
+        REQUIRE( largeCount == 0 );
+      }
+    }
+  }
+}
@@ -0,0 +1,129 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "pushmi/o/empty.h"
+#include "pushmi/o/just.h"
+#include "pushmi/o/measure.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/transform.h"
+
+using namespace pushmi::aliases;
+
+using namespace std::literals;
+
+SCENARIO( "a histogram records durations", "[measure]" ) {
+
+  GIVEN( "A histogram" ) {
+    mi::histogram h;
+
+    WHEN( "the values 1 to 1000 are recorded" ) {
+      for (std::uint64_t v = 1; v <= 1000; ++v) {
+        h.record(v);
+      }
+      auto s = h.snapshot();
+
+      THEN( "the percentiles are within the width of a bucket" ) {
+        REQUIRE( s.count() == 1000 );
+        REQUIRE( s.mean() == Approx(500.5) );
+        REQUIRE( s.min() == 1 );
+        REQUIRE( s.value_at(0.5) >= 500 );
+        REQUIRE( s.value_at(0.5) <= 500 + 500 / 32 );
+        REQUIRE( s.max() >= 1000 );
+        REQUIRE( s.max() <= 1000 + 1000 / 32 );
+      }
+    }
+
+    WHEN( "threads record at once and snapshots are merged" ) {
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&h] {
+          for (int i = 0; i < 1000; ++i) {
+            h.record(std::chrono::microseconds(1));
+          }
+        });
+      }
+      for (auto& t : threads) {
+        t.join();
+      }
+      mi::histogram other;
+      other.record(1ms);
+      auto s = h.snapshot();
+      s.merge(other.snapshot());
+
+      THEN( "every record is counted once" ) {
+        REQUIRE( s.count() == 4001 );
+        REQUIRE( s.value_at(0.99) < 1100 );
+        REQUIRE( s.max() >= 1000000 );
+      }
+    }
+
+    WHEN( "more threads than there are shards record at once" ) {
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 32; ++t) {
+        threads.emplace_back([&h] {
+          for (int i = 0; i < 1000; ++i) {
+            h.record(std::uint64_t(10));
+          }
+        });
+      }
+      for (auto& t : threads) {
+        t.join();
+      }
+      auto s = h.snapshot();
+
+      THEN( "the threads that share a shard do not lose records" ) {
+        REQUIRE( s.count() == 32000 );
+        REQUIRE( s.mean() == Approx(10.0) );
+      }
+    }
+  }
+}
+
+SCENARIO( "measure records the time from submit to each signal", "[measure]" ) {
+
+  GIVEN( "A histogram before and after a slow stage" ) {
+    mi::histogram before;
+    mi::histogram after;
+
+    WHEN( "a value goes through the stage" ) {
+      int value = 0;
+      op::just(1) |
+        op::measure(before) |
+        op::transform([](int v) {
+          std::this_thread::sleep_for(2ms);
+          return v + 1;
+        }) |
+        op::measure(after) |
+        op::submit([&](int v) { value = v; });
+      auto b = before.snapshot();
+      auto a = after.snapshot();
+
+      THEN( "only the measure after the stage includes its time" ) {
+        REQUIRE( value == 2 );
+        REQUIRE( b.count() == 1 );
+        REQUIRE( a.count() == 1 );
+        REQUIRE( a.max() >= 2000000 );
+        REQUIRE( b.max() < a.min() );
+      }
+    }
+
+    WHEN( "the sender is done" ) {
+      bool done = false;
+      op::empty<int>() |
+        op::measure(before) |
+        op::submit(
+          v::on_value([](int) {}),
+          v::on_error([](auto) noexcept {}),
+          v::on_done([&] { done = true; }));
+      auto b = before.snapshot();
+
+      THEN( "done is recorded" ) {
+        REQUIRE( done );
+        REQUIRE( b.count() == 1 );
+      }
+    }
+  }
+}
@@ -0,0 +1,54 @@
+// catch.hpp is not used here, with gcc 12 the standard headers that it
+// includes conflict with the ones in the global module fragment of pushmi.
+#include <cstdio>
+
+import pushmi;
+
+using namespace pushmi::aliases;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+  if (!condition) {
+    std::printf("FAILED: %s\n", what);
+    ++failures;
+  }
+}
+
+} // namespace
+
+int main() {
+  auto j = op::just(20);
+
+  {
+    int tapped = 0;
+    int result = 0;
+    j |
+      op::transform([](int v) { return v + 1; }) |
+      op::tap([&](int v) { tapped = v; }) |
+      op::filter([](int v) { return v > 1; }) |
+      op::submit([&](int v) { result = v * 2; });
+    check(result == 42, "the value goes through every stage");
+    check(tapped == 21, "the tap sees the transformed value");
+  }
+
+  {
+    bool done = false;
+    int value = 0;
+    j |
+      op::filter([](int v) { return v > 20; }) |
+      op::submit(
+        v::on_value([&](int v) { value = v; }),
+        v::on_error([](auto) noexcept {}),
+        v::on_done([&] { done = true; }));
+    check(done, "a rejected value signals done");
+    check(value == 0, "a rejected value is not delivered");
+  }
+
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures;
+}
@@ -0,0 +1,336 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pushmi/o/flow_from.h"
+#include "pushmi/o/publish.h"
+#include "pushmi/o/extension_operators.h"
+
+using namespace pushmi::aliases;
+
+namespace {
+
+// a flow receiver that records what it is given and keeps its up-channel,
+// starting with the given credit.
+struct recorder {
+  std::vector<int> values;
+  std::vector<const std::string*> strings;
+  std::atomic<bool> done{false};
+  bool overflowed = false;
+  v::any_many<std::ptrdiff_t>* up = nullptr;
+
+  template <class V>
+  auto receiver(std::ptrdiff_t credit) {
+    return v::make_flow_many(
+      [this](const V& v) { record(v); },
+      [this](std::exception_ptr e) noexcept {
+        try {
+          std::rethrow_exception(e);
+        } catch (const mi::replay_overflow&) {
+          overflowed = true;
+        } catch (...) {
+        }
+      },
+      [this]() { done = true; },
+      []() noexcept {},
+      [this, credit](v::any_many<std::ptrdiff_t>& u) {
+        up = &u;
+        ::pushmi::set_value(u, std::ptrdiff_t{credit});
+      });
+  }
+  void record(int v) {
+    values.push_back(v);
+  }
+  void record(const std::string& v) {
+    strings.push_back(&v);
+  }
+};
+
+const auto lots = std::numeric_limits<std::ptrdiff_t>::max() / 2;
+
+} // namespace
+
+SCENARIO( "publish replays the values still in the ring", "[replay_subject][publish]" ) {
+
+  GIVEN( "A flow_many sender over five ints published with a capacity of three" ) {
+    std::vector<int> source{1, 2, 3, 4, 5};
+    auto sub = op::flow_from(source.begin(), source.end()) | op::publish<int>(3);
+
+    WHEN( "a receiver is submitted after the values were produced" ) {
+      recorder r;
+      sub.submit(r.receiver<int>(lots));
+
+      THEN( "it gets the last three values and done" ) {
+        REQUIRE( r.values == std::vector<int>{3, 4, 5} );
+        REQUIRE( r.done );
+      }
+    }
+  }
+}
+
+SCENARIO( "replay_subject shares each value with every receiver", "[replay_subject]" ) {
+
+  GIVEN( "A replay_subject of strings" ) {
+    mi::replay_subject<std::string, mi::property_set<>> sub{4};
+    recorder a;
+    recorder b;
+    sub.submit(a.receiver<std::string>(lots));
+    sub.submit(b.receiver<std::string>(lots));
+
+    WHEN( "a value is produced" ) {
+      auto out = sub.receiver();
+      ::pushmi::set_value(out, std::string("quote"));
+      ::pushmi::set_done(out);
+
+      THEN( "both receivers read the same copy" ) {
+        REQUIRE( a.strings.size() == 1 );
+        REQUIRE( b.strings.size() == 1 );
+        REQUIRE( a.strings[0] == b.strings[0] );
+        REQUIRE( a.done );
+        REQUIRE( b.done );
+      }
+    }
+  }
+}
+
+SCENARIO( "replay_subject handles receivers that fall behind", "[replay_subject]" ) {
+
+  const std::size_t capacity = 4;
+
+  GIVEN( "A fast receiver and one that requested a single value" ) {
+
+    WHEN( "the oldest values are dropped" ) {
+      mi::replay_subject<int, mi::property_set<>> sub{capacity};
+      recorder fast;
+      recorder slow;
+      sub.submit(fast.receiver<int>(lots));
+      sub.submit(slow.receiver<int>(1));
+      auto out = sub.receiver();
+      for (int i = 0; i < 10; ++i) {
+        ::pushmi::set_value(out, i);
+      }
+      ::pushmi::set_done(out);
+      ::pushmi::set_value(*slow.up, std::ptrdiff_t{lots});
+
+      THEN( "the slow receiver skips to the values that are left" ) {
+        REQUIRE( fast.values.size() == 10 );
+        REQUIRE( fast.done );
+        REQUIRE( slow.values.front() == 0 );
+        REQUIRE( slow.values.size() >= capacity + 1 );
+        for (std::size_t i = 1; i < slow.values.size(); ++i) {
+          REQUIRE( slow.values[i] == int(10 - slow.values.size() + i) );
+        }
+        REQUIRE( slow.done );
+      }
+    }
+
+    WHEN( "the policy is error" ) {
+      mi::replay_subject<int, mi::property_set<>> sub{
+        capacity, mi::overflow_policy::error};
+      recorder fast;
+      recorder slow;
+      sub.submit(fast.receiver<int>(lots));
+      sub.submit(slow.receiver<int>(1));
+      auto out = sub.receiver();
+      for (int i = 0; i < 10; ++i) {
+        ::pushmi::set_value(out, i);
+      }
+      ::pushmi::set_done(out);
+
+      THEN( "the slow receiver is completed with replay_overflow" ) {
+        REQUIRE( fast.values.size() == 10 );
+        REQUIRE( fast.done );
+        REQUIRE( slow.values == std::vector<int>{0} );
+        REQUIRE( slow.overflowed );
+        REQUIRE( !slow.done );
+      }
+    }
+  }
+
+  GIVEN( "A producer thread and a receiver that requests one value at a time" ) {
+    mi::replay_subject<int, mi::property_set<>> sub{
+      2, mi::overflow_policy::block};
+    recorder slow;
+    sub.submit(slow.receiver<int>(1));
+
+    WHEN( "the policy is block" ) {
+      const int count = 1000;
+      std::thread producer{[out = sub.receiver()]() mutable {
+        for (int i = 0; i < count; ++i) {
+          ::pushmi::set_value(out, i);
+        }
+        ::pushmi::set_done(out);
+      }};
+      while (!slow.done) {
+        ::pushmi::set_value(*slow.up, 1);
+        std::this_thread::yield();
+      }
+      producer.join();
+
+      THEN( "no value is lost" ) {
+        std::vector<int> expected(count);
+        std::iota(expected.begin(), expected.end(), 0);
+        REQUIRE( slow.values == expected );
+      }
+    }
+  }
+
+  GIVEN( "A producer thread and receivers that subscribe while it produces" ) {
+    // receivers that have not requested values overflow quickly
+    mi::replay_subject<int, mi::property_set<>> sub{
+      4, mi::overflow_policy::error};
+    std::atomic<int> early{0};
+    std::atomic<int> finished{0};
+    // a receiver that takes its time to start and counts the signals that
+    // arrive before it has started.
+    auto late = [&]() {
+      auto started = std::make_shared<std::atomic<bool>>(false);
+      return v::make_flow_many(
+        [&early, started](int) { early += !*started; },
+        [&early, &finished, started](std::exception_ptr) noexcept {
+          early += !*started;
+          ++finished;
+        },
+        [&early, &finished, started]() {
+          early += !*started;
+          ++finished;
+        },
+        [&early, &finished, started]() noexcept {
+          early += !*started;
+          ++finished;
+        },
+        [started](v::any_many<std::ptrdiff_t>& up) {
+          std::this_thread::sleep_for(std::chrono::microseconds(100));
+          *started = true;
+          ::pushmi::set_value(up, std::ptrdiff_t{lots});
+        });
+    };
+
+    WHEN( "the receivers are submitted concurrently with the values" ) {
+      const int receivers = 200;
+      std::thread producer{[out = sub.receiver()]() mutable {
+        for (int i = 0; i < 20000; ++i) {
+          ::pushmi::set_value(out, i);
+        }
+        ::pushmi::set_done(out);
+      }};
+      for (int i = 0; i < receivers; ++i) {
+        sub.submit(late());
+      }
+      producer.join();
+
+      THEN( "no receiver gets a value or done before starting" ) {
+        REQUIRE( early == 0 );
+        REQUIRE( finished == receivers );
+      }
+    }
+  }
+}
+
+SCENARIO( "replay_subject frees the receivers that are finished", "[replay_subject]" ) {
+
+  // a flow receiver that holds alive and cancels as soon as it starts.
+  auto cancelling = [](std::shared_ptr<int> alive) {
+    return v::make_flow_many(
+      [alive](int) {},
+      [](std::exception_ptr) noexcept {},
+      []() {},
+      []() noexcept {},
+      [](v::any_many<std::ptrdiff_t>& up) { ::pushmi::set_done(up); });
+  };
+
+  GIVEN( "A replay_subject with a receiver that keeps reading" ) {
+    mi::replay_subject<int, mi::property_set<>> sub{4};
+    auto out = sub.receiver();
+    recorder live;
+    sub.submit(live.receiver<int>(lots));
+
+    WHEN( "receivers subscribe and cancel between the values" ) {
+      auto alive = std::make_shared<int>(0);
+      for (int i = 0; i < 100; ++i) {
+        for (int j = 0; j < 10; ++j) {
+          sub.submit(cancelling(alive));
+        }
+        ::pushmi::set_value(out, i);
+      }
+
+      THEN( "only the receiver that keeps reading is kept" ) {
+        REQUIRE( live.values.size() == 100 );
+        REQUIRE( alive.use_count() == 1 );
+      }
+    }
+
+    WHEN( "receivers subscribe and cancel on another thread" ) {
+      auto alive = std::make_shared<int>(0);
+      std::atomic<bool> stop{false};
+      std::thread churn{[&sub, &stop, &cancelling, alive] {
+        while (!stop) {
+          sub.submit(cancelling(alive));
+        }
+      }};
+      for (int i = 0; i < 1000; ++i) {
+        ::pushmi::set_value(out, i);
+      }
+      stop = true;
+      churn.join();
+      ::pushmi::set_value(out, 1000);
+
+      THEN( "the finished receivers are freed by the producer" ) {
+        REQUIRE( live.values.size() == 1001 );
+        REQUIRE( alive.use_count() == 1 );
+      }
+    }
+  }
+
+  GIVEN( "A receiver of a replay_subject that is never completed" ) {
+    auto alive = std::make_shared<int>(0);
+    auto done = std::make_shared<bool>(false);
+    {
+      mi::replay_subject<int, mi::property_set<>> sub{4};
+      sub.submit(v::make_flow_many(
+        [alive](int) {},
+        [](std::exception_ptr) noexcept {},
+        [done]() { *done = true; },
+        []() noexcept {},
+        [](v::any_many<std::ptrdiff_t>& up) {
+          ::pushmi::set_value(up, std::ptrdiff_t{lots});
+        }));
+      ::pushmi::set_value(sub.receiver(), 1);
+    }
+
+    WHEN( "the subject and its receivers are gone" ) {
+
+      THEN( "the receiver is completed with done and freed" ) {
+        REQUIRE( *done );
+        REQUIRE( alive.use_count() == 1 );
+      }
+    }
+  }
+
+  GIVEN( "A receiver that requested one of two values of a replay_subject" ) {
+    recorder slow;
+    {
+      mi::replay_subject<int, mi::property_set<>> sub{4};
+      sub.submit(slow.receiver<int>(1));
+      auto out = sub.receiver();
+      ::pushmi::set_value(out, 1);
+      ::pushmi::set_value(out, 2);
+    }
+
+    WHEN( "it requests more after the subject is gone" ) {
+      ::pushmi::set_value(*slow.up, std::ptrdiff_t{10});
+
+      THEN( "it reads the value that is left and is completed with done" ) {
+        REQUIRE( slow.values == std::vector<int>{1, 2} );
+        REQUIRE( slow.done );
+      }
+    }
+  }
+}
@@ -0,0 +1,142 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+using namespace std::literals;
+
+#include "pushmi/o/just.h"
+#include "pushmi/o/retry.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/extension_operators.h"
+
+#include "pushmi/new_thread.h"
+#include "pushmi/trampoline.h"
+
+using namespace pushmi::aliases;
+
+SCENARIO( "retry resubmits a failed upstream after a delay", "[retry]" ) {
+
+  GIVEN( "A time executor that counts timers and an upstream that fails until the third attempt" ) {
+    auto nt = v::new_thread();
+    auto timers = std::make_shared<std::atomic<int>>(0);
+    auto counting = v::make_time_single_deferred(
+      [nt, timers](auto at, auto out) mutable {
+        ++*timers;
+        ::pushmi::submit(nt, at, std::move(out));
+      });
+    auto attempts = std::make_shared<std::atomic<int>>(0);
+    auto flaky = v::make_single_deferred([attempts](auto out) {
+      if (++*attempts < 3) {
+        ::pushmi::set_error(out, std::make_exception_ptr(std::runtime_error("flaky")));
+      } else {
+        ::pushmi::set_value(out, 42);
+      }
+    });
+
+    WHEN( "enough retries are allowed" ) {
+      auto v = flaky | op::retry(mi::exponential_backoff{1ms, 10ms, 5}, counting) |
+        op::get<int>;
+
+      THEN( "the value of the successful attempt is delivered" ) {
+        REQUIRE( v == 42 );
+        REQUIRE( *attempts == 3 );
+        REQUIRE( *timers == 2 );
+      }
+    }
+
+    WHEN( "the timers wait on the trampoline of the task that failed" ) {
+      // new_thread runs its tasks on a trampoline, so each timer is queued
+      // behind the attempt that asked for it.
+      auto result = std::make_shared<std::promise<int>>();
+      auto start = std::chrono::steady_clock::now();
+      nt | op::submit([flaky, result](auto) {
+        flaky |
+          op::retry(mi::exponential_backoff{50ms, 50ms, 5, 0.0}, mi::trampoline()) |
+          op::submit(
+            [result](int v){ result->set_value(v); },
+            [result](auto) noexcept { result->set_value(-1); });
+      });
+      auto v = result->get_future().get();
+      auto elapsed = std::chrono::steady_clock::now() - start;
+
+      THEN( "each retry waits for its delay" ) {
+        REQUIRE( v == 42 );
+        REQUIRE( *attempts == 3 );
+        REQUIRE( elapsed >= 100ms );
+      }
+    }
+
+    WHEN( "the retries run out" ) {
+      bool failed = false;
+      try {
+        flaky | op::retry(mi::exponential_backoff{1ms, 10ms, 1}, counting) |
+          op::get<int>;
+      } catch (const std::runtime_error&) {
+        failed = true;
+      }
+
+      THEN( "the last error is delivered" ) {
+        REQUIRE( failed );
+        REQUIRE( *attempts == 2 );
+        REQUIRE( *timers == 1 );
+      }
+    }
+  }
+
+  GIVEN( "A time executor that runs timers inline and an upstream that fails during submit" ) {
+    auto inline_time = v::make_time_single_deferred([](auto at, auto out) {
+      std::this_thread::sleep_until(at);
+      ::pushmi::set_value(out, 0);
+    });
+    auto depth = std::make_shared<std::pair<const char*, std::ptrdiff_t>>();
+    auto attempts = std::make_shared<int>(0);
+    auto failing = v::make_single_deferred([depth, attempts](auto out) {
+      char here;
+      if ((*attempts)++ == 0) {
+        depth->first = &here;
+      }
+      depth->second = std::max(depth->second, std::abs(depth->first - &here));
+      ::pushmi::set_error(out, std::make_exception_ptr(std::runtime_error("always")));
+    });
+
+    WHEN( "it is retried many times" ) {
+      auto policy = [](std::size_t retry) {
+        return mi::retry_decision{retry <= 1000, 0ns};
+      };
+      bool failed = false;
+      try {
+        failing | op::retry(policy, inline_time) | op::get<int>;
+      } catch (const std::runtime_error&) {
+        failed = true;
+      }
+
+      THEN( "the attempts do not grow the stack" ) {
+        REQUIRE( failed );
+        REQUIRE( *attempts == 1001 );
+        REQUIRE( depth->second < 4096 );
+      }
+    }
+  }
+
+  GIVEN( "An exponential backoff policy" ) {
+    mi::exponential_backoff backoff{1ms, 8ms, 5, 0.5};
+
+    THEN( "delays double up to the cap, shortened by at most the jitter" ) {
+      auto expected = {1ms, 2ms, 4ms, 8ms, 8ms};
+      std::size_t retry = 1;
+      for (auto full : expected) {
+        auto decision = backoff(retry++);
+        REQUIRE( decision.retry );
+        REQUIRE( decision.delay <= full );
+        REQUIRE( decision.delay >= full / 2 );
+      }
+      REQUIRE( !backoff(retry).retry );
+    }
+  }
+}
@@ -0,0 +1,112 @@
+#include "catch.hpp"
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "pushmi/o/single_flight.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/extension_operators.h"
+
+using namespace pushmi::aliases;
+
+namespace {
+
+// an upstream that completes only when the test says so.
+struct pending {
+  int submits = 0;
+  std::vector<std::function<void(int)>> outs;
+  std::vector<std::function<void()>> fails;
+
+  auto sender() {
+    return v::make_single_deferred([this](auto out) {
+      ++submits;
+      auto o = std::make_shared<decltype(out)>(std::move(out));
+      outs.push_back([o](int v) { ::pushmi::set_value(*o, v); });
+      fails.push_back([o] {
+        ::pushmi::set_error(*o, std::make_exception_ptr(std::runtime_error("down")));
+      });
+    });
+  }
+};
+
+} // namespace
+
+SCENARIO( "single_flight joins concurrent submits for the same key", "[single_flight]" ) {
+
+  GIVEN( "An upstream that has not completed yet behind single_flight" ) {
+    pending p;
+    std::string key = "user";
+    auto flight = op::single_flight<int>([&key] { return key; });
+    std::vector<int> values;
+    auto record = [&](int v) { values.push_back(v); };
+
+    WHEN( "the same key is submitted twice before it completes" ) {
+      p.sender() | flight | op::submit(record);
+      p.sender() | flight | op::submit(record);
+      p.outs.at(0)(42);
+
+      THEN( "the upstream runs once and both get its value" ) {
+        REQUIRE( p.submits == 1 );
+        REQUIRE( values == std::vector<int>{42, 42} );
+      }
+
+      AND_WHEN( "the key is submitted after the flight completed" ) {
+        p.sender() | flight | op::submit(record);
+
+        THEN( "a new flight is started" ) {
+          REQUIRE( p.submits == 2 );
+          REQUIRE( values.size() == 2 );
+          p.outs.at(1)(7);
+          REQUIRE( values == std::vector<int>{42, 42, 7} );
+        }
+      }
+    }
+
+    WHEN( "different keys are submitted" ) {
+      p.sender() | flight | op::submit(record);
+      key = "group";
+      p.sender() | flight | op::submit(record);
+
+      THEN( "each key has its own flight" ) {
+        REQUIRE( p.submits == 2 );
+        p.outs.at(1)(2);
+        p.outs.at(0)(1);
+        REQUIRE( values == std::vector<int>{2, 1} );
+      }
+    }
+
+    WHEN( "the flight fails" ) {
+      int errors = 0;
+      for (int i = 0; i < 3; ++i) {
+        p.sender() | flight | op::submit(record, [&](auto) noexcept { ++errors; });
+      }
+      p.fails.at(0)();
+
+      THEN( "every joined submit gets the error" ) {
+        REQUIRE( p.submits == 1 );
+        REQUIRE( errors == 3 );
+        REQUIRE( values.empty() );
+      }
+    }
+
+    WHEN( "the submit of the upstream throws" ) {
+      int errors = 0;
+      auto throwing = v::make_single_deferred([&p](auto) {
+        ++p.submits;
+        throw std::runtime_error("refused");
+      });
+      throwing | flight | op::submit(record, [&](auto) noexcept { ++errors; });
+      p.sender() | flight | op::submit(record);
+      p.outs.at(0)(5);
+
+      THEN( "the flight fails and the key starts a new flight" ) {
+        REQUIRE( p.submits == 2 );
+        REQUIRE( errors == 1 );
+        REQUIRE( values == std::vector<int>{5} );
+      }
+    }
+  }
+}
@@ -0,0 +1,130 @@
+#include "catch.hpp"
+
+#include <memory>
+
+#include "pushmi/o/just.h"
+#include "pushmi/o/filter.h"
+#include "pushmi/o/transform.h"
+#include "pushmi/o/tap.h"
+#include "pushmi/o/via.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/extension_operators.h"
+
+#include "pushmi/new_thread.h"
+#include "pushmi/trampoline.h"
+
+using namespace pushmi::aliases;
+
+namespace {
+
+struct record {
+  mi::stop_source source;
+  int values = 0;
+  int last = 0;
+  bool done = false;
+};
+
+struct stoppable_receiver {
+  using properties =
+    mi::property_set<mi::is_receiver<>, mi::is_single<>, mi::is_stoppable<>>;
+  std::shared_ptr<record> r;
+  template <class V>
+  void value(V&&) {
+    ++r->values;
+  }
+  void value(int v) {
+    ++r->values;
+    r->last = v;
+  }
+  void error(std::exception_ptr) noexcept {}
+  void done() {
+    r->done = true;
+  }
+  mi::stop_token get_stop_token() const {
+    return r->source.get_token();
+  }
+};
+
+struct unmarked_receiver {
+  using properties = mi::property_set<mi::is_receiver<>, mi::is_single<>>;
+  mi::stop_source source;
+  void value(int) {}
+  void error(std::exception_ptr) noexcept {}
+  void done() {}
+  mi::stop_token get_stop_token() const {
+    return source.get_token();
+  }
+};
+
+} // namespace
+
+SCENARIO( "stop tokens are forwarded by operators and checked by executors", "[stop_token]" ) {
+
+  GIVEN( "A receiver with the stoppable property" ) {
+    auto r = std::make_shared<record>();
+
+    WHEN( "it is submitted through transform, filter and tap" ) {
+      auto seen = std::make_shared<mi::stop_token>();
+      auto source = v::make_single_deferred([seen](auto out) {
+        *seen = ::pushmi::get_stop_token(out);
+        ::pushmi::set_value(out, 1);
+      });
+      source |
+        op::transform([](int v) { return v + 1; }) |
+        op::filter([](int) { return true; }) |
+        op::tap([](int) {}) |
+        op::submit(stoppable_receiver{r});
+
+      THEN( "the upstream sees the token of the receiver" ) {
+        REQUIRE( r->values == 1 );
+        REQUIRE( r->last == 2 );
+        REQUIRE( seen->stop_possible() );
+        REQUIRE( !seen->stop_requested() );
+        r->source.request_stop();
+        REQUIRE( seen->stop_requested() );
+      }
+    }
+
+    WHEN( "it asked to stop before the trampoline runs it" ) {
+      r->source.request_stop();
+      auto tr = mi::trampoline();
+      ::pushmi::submit(tr, ::pushmi::now(tr), stoppable_receiver{r});
+
+      THEN( "it is completed with done" ) {
+        REQUIRE( r->values == 0 );
+        REQUIRE( r->done );
+      }
+    }
+
+    WHEN( "it asked to stop before via delivers the value" ) {
+      r->source.request_stop();
+      op::just(42) | op::via([]{ return mi::trampoline(); }) |
+        op::submit(stoppable_receiver{r});
+
+      THEN( "it is completed with done" ) {
+        REQUIRE( r->values == 0 );
+        REQUIRE( r->done );
+      }
+    }
+
+    WHEN( "it asked to stop before a new thread runs it" ) {
+      r->source.request_stop();
+      auto nt = v::new_thread();
+      nt | op::transform([](auto) { return 42; }) |
+        op::blocking_submit(stoppable_receiver{r});
+
+      THEN( "it is completed with done" ) {
+        REQUIRE( r->values == 0 );
+        REQUIRE( r->done );
+      }
+    }
+  }
+
+  GIVEN( "Receivers without the stoppable property" ) {
+    THEN( "they get a token that never stops" ) {
+      REQUIRE( !::pushmi::get_stop_token(mi::make_single()).stop_possible() );
+      unmarked_receiver unmarked;
+      REQUIRE( !::pushmi::get_stop_token(unmarked).stop_possible() );
+    }
+  }
+}
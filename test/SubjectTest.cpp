@@ -0,0 +1,85 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pushmi/o/submit.h"
+#include "pushmi/o/extension_operators.h"
+
+#include "pushmi/subject.h"
+
+using namespace pushmi::aliases;
+
+SCENARIO( "subject shares one value with every receiver", "[subject]" ) {
+
+  GIVEN( "A subject of strings" ) {
+    mi::subject<std::string, mi::property_set<>> sub;
+
+    WHEN( "receivers are submitted before and after the value" ) {
+      std::vector<const std::string*> seen;
+      auto record = [&](const std::string& v) { seen.push_back(&v); };
+      sub | op::submit(record);
+      sub | op::submit(record);
+      ::pushmi::set_value(sub.receiver(), std::string("shared"));
+      sub | op::submit(record);
+
+      THEN( "they all read the same stored value" ) {
+        REQUIRE( seen.size() == 3 );
+        REQUIRE( *seen[0] == "shared" );
+        REQUIRE( seen[0] == seen[1] );
+        REQUIRE( seen[0] == seen[2] );
+      }
+    }
+
+    WHEN( "it is completed twice" ) {
+      int values = 0;
+      bool done = false;
+      sub | op::submit([&](auto) { ++values; }, [](auto) noexcept {}, [&] { done = true; });
+      auto out = sub.receiver();
+      ::pushmi::set_value(out, std::string("first"));
+      ::pushmi::set_done(out);
+
+      THEN( "only the first signal is delivered" ) {
+        REQUIRE( values == 1 );
+        REQUIRE( !done );
+      }
+    }
+  }
+
+  GIVEN( "Threads that submit receivers while the value arrives" ) {
+    mi::subject<int, mi::property_set<>> sub;
+    const int threads = 4;
+    const int each = 250;
+    std::atomic<int> delivered{0};
+    std::atomic<int> sum{0};
+    std::atomic<bool> go{false};
+
+    WHEN( "the subscribers race with the value" ) {
+      std::vector<std::thread> pool;
+      for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&] {
+          while (!go.load()) {}
+          for (int i = 0; i < each; ++i) {
+            sub | op::submit([&](int v) {
+              sum += v;
+              ++delivered;
+            });
+          }
+        });
+      }
+      go = true;
+      ::pushmi::set_value(sub.receiver(), 1);
+      for (auto& t : pool) {
+        t.join();
+      }
+
+      THEN( "each receiver gets the value exactly once" ) {
+        REQUIRE( delivered == threads * each );
+        REQUIRE( sum == threads * each );
+      }
+    }
+  }
+}
@@ -0,0 +1,188 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+using namespace std::literals;
+
+#include "pushmi/o/just.h"
+#include "pushmi/o/transform.h"
+#include "pushmi/o/timeout.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/extension_operators.h"
+
+#include "pushmi/new_thread.h"
+#include "pushmi/trampoline.h"
+
+#include "manual_time.h"
+
+using namespace pushmi::aliases;
+
+SCENARIO( "timeout completes with the upstream or with an error", "[timeout]" ) {
+
+  GIVEN( "A manual clock and an upstream that the test completes" ) {
+    pushmi_test::manual_time time;
+    auto outs = std::make_shared<std::vector<v::any_single<int>>>();
+    auto tokens = std::make_shared<std::vector<mi::stop_token>>();
+    auto later = v::make_single_deferred([outs, tokens](auto out) {
+      tokens->push_back(::pushmi::get_stop_token(out));
+      outs->emplace_back(std::move(out));
+    });
+    auto alive = std::make_shared<int>(0);
+    std::weak_ptr<int> watch = alive;
+    int values = 0;
+    int timeouts = 0;
+    auto receiver = [&values, &timeouts]() {
+      return v::make_single(
+        [&values](int v) { values += v; },
+        [&timeouts](std::exception_ptr e) noexcept {
+          try {
+            std::rethrow_exception(e);
+          } catch (const mi::timeout_error&) {
+            ++timeouts;
+          } catch (...) {
+          }
+        });
+    };
+
+    WHEN( "the upstream completes during submit" ) {
+      auto v = op::just(42) | op::timeout(1s, time.executor()) | op::get<int>;
+
+      THEN( "the value is delivered and no timer is registered" ) {
+        REQUIRE( v == 42 );
+        REQUIRE( time.submitted() == 0 );
+      }
+    }
+
+    WHEN( "requests complete long before their timeout" ) {
+      for (int i = 0; i < 20; ++i) {
+        later | op::timeout(1s, time.executor()) |
+          op::submit([&values, alive](int v) { values += v; });
+      }
+      alive.reset();
+      time.advance(999ms);
+      for (auto& out : *outs) {
+        ::pushmi::set_value(out, 1);
+      }
+      outs->clear();
+      tokens->clear();
+      time.advance(0ms);
+
+      THEN( "the values are delivered and no timer holds the receiver" ) {
+        REQUIRE( values == 20 );
+        REQUIRE( time.submitted() == 20 );
+        REQUIRE( time.waiting() == 0 );
+        REQUIRE( watch.expired() );
+      }
+    }
+
+    WHEN( "the upstream never completes" ) {
+      later | op::timeout(10ms, time.executor()) | op::submit(receiver());
+      time.advance(9ms);
+      const int early = timeouts;
+      time.advance(1ms);
+
+      THEN( "a timeout error is delivered at the deadline and the upstream is asked to stop" ) {
+        REQUIRE( early == 0 );
+        REQUIRE( timeouts == 1 );
+        REQUIRE( values == 0 );
+        REQUIRE( time.submitted() == 1 );
+        REQUIRE( tokens->front().stop_possible() );
+        REQUIRE( tokens->front().stop_requested() );
+      }
+
+      WHEN( "the upstream completes after the timeout" ) {
+        ::pushmi::set_value(outs->front(), 1);
+
+        THEN( "the value is dropped" ) {
+          REQUIRE( timeouts == 1 );
+          REQUIRE( values == 0 );
+        }
+      }
+    }
+  }
+
+  // the timers below wait on threads, with deadlines far beyond the time
+  // the upstream takes, so that only a timer that is not woken fails them.
+  GIVEN( "A new_thread executor" ) {
+    auto nt = v::new_thread();
+
+    WHEN( "the upstream completes first on another thread" ) {
+      auto v = nt | op::transform([](auto){ return 7; }) |
+        op::timeout(60s, nt) | op::get<int>;
+
+      THEN( "the value is delivered" ) {
+        REQUIRE( v == 7 );
+      }
+    }
+
+    WHEN( "the timer waits on the trampoline of the submitting thread" ) {
+      auto start = std::chrono::steady_clock::now();
+      auto v = nt |
+        op::transform([](auto){
+          std::this_thread::sleep_for(10ms);
+          return 3;
+        }) |
+        op::timeout(60s, mi::trampoline()) | op::get<int>;
+      auto elapsed = std::chrono::steady_clock::now() - start;
+
+      THEN( "submit returns once the upstream completes" ) {
+        REQUIRE( v == 3 );
+        REQUIRE( elapsed < 30s );
+      }
+    }
+
+    WHEN( "the timer is queued behind the task that submitted it" ) {
+      // new_thread runs its tasks on a trampoline, so the timer waits in
+      // the trampoline of that thread once the task returns.
+      auto result = std::make_shared<std::promise<int>>();
+      auto alive = std::make_shared<int>(0);
+      std::weak_ptr<int> watch = alive;
+      nt | op::submit([nt, result, alive](auto) {
+        nt |
+          op::transform([](auto){
+            std::this_thread::sleep_for(10ms);
+            return 3;
+          }) |
+          op::timeout(60s, mi::trampoline()) |
+          op::submit(
+            [result, alive](int v){ result->set_value(v); },
+            [result](auto) noexcept { result->set_value(-1); });
+      });
+      alive.reset();
+      auto v = result->get_future().get();
+      auto deadline = std::chrono::steady_clock::now() + 30s;
+      while (!watch.expired() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+      }
+
+      THEN( "the upstream wins and the timer stops waiting once it has" ) {
+        REQUIRE( v == 3 );
+        REQUIRE( watch.expired() );
+      }
+    }
+
+    WHEN( "the timer is queued behind a task and the upstream never completes" ) {
+      auto never = v::make_single_deferred([](auto out) {});
+      auto result = std::make_shared<std::promise<bool>>();
+      auto start = std::chrono::system_clock::now();
+      nt | op::submit([never, result](auto) {
+        never |
+          op::timeout(100ms, mi::trampoline()) |
+          op::submit(
+            [result](int){ result->set_value(false); },
+            [result](auto) noexcept { result->set_value(true); });
+      });
+      auto timed_out = result->get_future().get();
+      auto elapsed = std::chrono::system_clock::now() - start;
+
+      THEN( "the timer fires at its deadline and not before" ) {
+        REQUIRE( timed_out );
+        REQUIRE( elapsed >= 100ms );
+      }
+    }
+  }
+}
@@ -34,6 +34,26 @@ struct countdownsingle {
   }
 };
 
+// a receiver for a timer that is cancelled through its stop source.
+struct cancellable_timer {
+  using properties =
+    mi::property_set<mi::is_receiver<>, mi::is_single<>, mi::is_stoppable<>>;
+  mi::stop_source source;
+  int* values;
+  int* dones;
+  template <class V>
+  void value(V&&) {
+    ++*values;
+  }
+  void error(std::exception_ptr) noexcept {}
+  void done() {
+    ++*dones;
+  }
+  mi::stop_token get_stop_token() const {
+    return source.get_token();
+  }
+};
+
 SCENARIO( "trampoline executor", "[trampoline][deferred]" ) {
 
   GIVEN( "A trampoline time_single_deferred" ) {
@@ -96,6 +116,25 @@ SCENARIO( "trampoline executor", "[trampoline][deferred]" ) {
       }
     }
 
+    WHEN( "a timer far in the future is cancelled by earlier work" ) {
+      int values = 0;
+      int dones = 0;
+      mi::stop_source source;
+      auto start = std::chrono::steady_clock::now();
+      tr | op::submit(v::on_value([&](auto tr) {
+        tr |
+            op::submit_after(60s, cancellable_timer{source, &values, &dones}) |
+            op::submit_after(10ms, v::on_value([&](auto) { source.request_stop(); }));
+      }));
+      auto elapsed = std::chrono::steady_clock::now() - start;
+
+      THEN( "the timer is completed with done without waiting for its time" ) {
+        REQUIRE( values == 0 );
+        REQUIRE( dones == 1 );
+        REQUIRE( elapsed < 30s );
+      }
+    }
+
     WHEN( "now is called" ) {
       bool done = false;
       tr | ep::now();
@@ -149,6 +188,15 @@ SCENARIO( "trampoline executor", "[trampoline][deferred]" ) {
       }
     }
 
+    WHEN( "used with on and just" ) {
+      int value = 0;
+      op::just(42) | op::on([&](){return tr;}) |
+          op::submit([&](int v) { value = v; });
+      THEN( "the value is delivered" ) {
+        REQUIRE(value == 42);
+      }
+    }
+
     WHEN( "used with via" ) {
       std::vector<std::string> values;
       auto deferred = pushmi::make_single_deferred([](auto out) {
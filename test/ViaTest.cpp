@@ -0,0 +1,235 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pushmi/o/just.h"
+#include "pushmi/o/via.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/extension_operators.h"
+
+#include "pushmi/time_single_deferred.h"
+
+#include "allocations.h"
+
+using namespace pushmi::aliases;
+
+namespace {
+
+// an executor that queues its work until the test runs it, and that the
+// test can declare current.
+struct queue_state {
+  bool current = false;
+  int submits = 0;
+  std::deque<std::function<void()>> work;
+
+  void run() {
+    while (!work.empty()) {
+      auto next = std::move(work.front());
+      work.pop_front();
+      next();
+    }
+  }
+};
+
+struct queue_submit {
+  std::shared_ptr<queue_state> s;
+  bool is_current() const {
+    return s->current;
+  }
+  template <class TP, class Out>
+  void operator()(TP, Out out) {
+    ++s->submits;
+    auto o = std::make_shared<Out>(std::move(out));
+    s->work.push_back([o] { ::pushmi::set_value(*o, 0); });
+  }
+};
+
+// an executor that keeps its work in type erased singles, so that it does
+// not allocate as long as the receivers that it is given fit in-situ.
+struct slot_submit {
+  std::shared_ptr<std::vector<mi::any_single<int>>> work;
+  template <class TP, class Out>
+  void operator()(TP, Out out) {
+    work->emplace_back(std::move(out));
+  }
+};
+
+// an executor with one worker thread that keeps its work in type erased
+// singles, in a queue with room for all of it, so that neither submit nor
+// the worker allocate. completed counts the work that the worker has run
+// and destroyed.
+struct worker_state {
+  std::mutex lock;
+  std::condition_variable wake;
+  std::vector<mi::any_single<int>> work;
+  std::atomic<int> completed{0};
+  bool stop = false;
+  std::thread thread;
+
+  explicit worker_state(std::size_t capacity) {
+    work.reserve(capacity);
+    thread = std::thread{[this] { run(); }};
+  }
+  ~worker_state() {
+    {
+      std::unique_lock<std::mutex> guard{lock};
+      stop = true;
+    }
+    wake.notify_one();
+    thread.join();
+  }
+  void run() {
+    std::unique_lock<std::mutex> guard{lock};
+    for (;;) {
+      wake.wait(guard, [this] { return stop || !work.empty(); });
+      if (work.empty()) {
+        return;
+      }
+      {
+        auto out = std::move(work.back());
+        work.pop_back();
+        guard.unlock();
+        ::pushmi::set_value(out, 0);
+      }
+      ++completed;
+      guard.lock();
+    }
+  }
+};
+
+struct worker_submit {
+  std::shared_ptr<worker_state> s;
+  template <class TP, class Out>
+  void operator()(TP, Out out) {
+    {
+      std::unique_lock<std::mutex> guard{s->lock};
+      s->work.emplace_back(std::move(out));
+    }
+    s->wake.notify_one();
+  }
+};
+
+} // namespace
+
+SCENARIO( "via delivers inline on an executor that is current", "[via]" ) {
+
+  GIVEN( "An executor that queues its work" ) {
+    auto s = std::make_shared<queue_state>();
+    auto exec = v::make_time_single_deferred(queue_submit{s});
+    auto factory = [exec] { return exec; };
+
+    WHEN( "it is not current" ) {
+      int value = 0;
+      op::just(42) | op::via(factory) | op::submit([&](int v) { value = v; });
+
+      THEN( "the value is submitted to it" ) {
+        REQUIRE( s->submits == 1 );
+        REQUIRE( value == 0 );
+        s->run();
+        REQUIRE( value == 42 );
+      }
+    }
+
+    WHEN( "it is current" ) {
+      s->current = true;
+      int value = 0;
+      op::just(42) | op::via(factory) | op::submit([&](int v) { value = v; });
+
+      THEN( "the value is delivered inline" ) {
+        REQUIRE( s->submits == 0 );
+        REQUIRE( value == 42 );
+      }
+    }
+
+    WHEN( "inline deliveries nest" ) {
+      s->current = true;
+      const int limit = mi::detail::via_inline_limit;
+      int delivered = 0;
+      int deepest = 0;
+      std::function<void(int)> hop = [&](int n) {
+        op::just(n) | op::via(factory) | op::submit([&](int n) {
+          ++delivered;
+          deepest = std::max(deepest, mi::detail::via_inline::depth());
+          if (n > 0) {
+            hop(n - 1);
+          }
+        });
+      };
+      hop(3 * (limit + 1) - 1);
+      s->run();
+
+      THEN( "the nesting is bounded and the rest is submitted" ) {
+        REQUIRE( delivered == 3 * (limit + 1) );
+        REQUIRE( deepest == limit );
+        REQUIRE( s->submits == 3 );
+      }
+    }
+  }
+}
+
+SCENARIO( "via does not allocate for a hop once warm", "[via]" ) {
+
+  GIVEN( "An executor that stores its work without allocating" ) {
+    auto work = std::make_shared<std::vector<mi::any_single<int>>>();
+    work->reserve(4);
+    auto exec = v::make_time_single_deferred(slot_submit{work});
+    auto factory = [exec] { return exec; };
+    int value = 0;
+    auto hop = [&](int v) {
+      op::just(v) | op::via(factory) | op::submit([&](int v) { value = v; });
+      for (auto& out : *work) {
+        ::pushmi::set_value(out, 0);
+      }
+      work->clear();
+    };
+
+    WHEN( "a value hops to it after the first hop" ) {
+      hop(1);
+      const auto before = pushmi_test::allocations();
+      hop(42);
+      const auto after = pushmi_test::allocations();
+
+      THEN( "the hop does not touch the heap" ) {
+        REQUIRE( value == 42 );
+        REQUIRE( after == before );
+      }
+    }
+  }
+
+  GIVEN( "An executor that runs its work on another thread" ) {
+    auto worker = std::make_shared<worker_state>(4);
+    auto exec = v::make_time_single_deferred(worker_submit{worker});
+    auto factory = [exec] { return exec; };
+    std::atomic<int> value{0};
+    int hops = 0;
+    auto hop = [&](int v) {
+      op::just(v) | op::via(factory) | op::submit([&](int v) { value = v; });
+      ++hops;
+      while (worker->completed != hops) {
+        std::this_thread::yield();
+      }
+    };
+
+    WHEN( "values hop to it after the first hop" ) {
+      hop(1);
+      const auto before = pushmi_test::allocations();
+      for (int i = 0; i < 1000; ++i) {
+        hop(i);
+      }
+      const auto after = pushmi_test::allocations();
+
+      THEN( "the blocks released on the worker are reused by the hops" ) {
+        REQUIRE( value == 999 );
+        REQUIRE( after == before );
+      }
+    }
+  }
+}
@@ -0,0 +1,148 @@
+#include "catch.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "pushmi/o/just.h"
+#include "pushmi/o/empty.h"
+#include "pushmi/o/transform.h"
+#include "pushmi/o/when_all.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/extension_operators.h"
+
+#include "pushmi/new_thread.h"
+
+using namespace pushmi::aliases;
+
+SCENARIO( "when_all joins a fixed set of senders", "[when_all]" ) {
+
+  GIVEN( "Two senders of different types" ) {
+    auto w = op::when_all<int, std::string>(op::just(42), op::just(std::string{"forty two"}));
+
+    WHEN( "the result is waited on" ) {
+      auto result = w | op::get<std::tuple<int, std::string>>;
+
+      THEN( "both values are delivered in order" ) {
+        REQUIRE( std::get<0>(result) == 42 );
+        REQUIRE( std::get<1>(result) == "forty two" );
+      }
+    }
+  }
+
+  GIVEN( "Senders that complete on other threads" ) {
+    auto nt = v::new_thread();
+    auto w = op::when_all<int, int, int>(
+      nt | op::transform([](auto){ return 1; }),
+      op::just(2),
+      nt | op::transform([](auto){ return 3; }));
+
+    WHEN( "the result is waited on" ) {
+      auto result = w | op::get<std::tuple<int, int, int>>;
+
+      THEN( "every value is delivered" ) {
+        REQUIRE( result == std::make_tuple(1, 2, 3) );
+      }
+    }
+  }
+
+  GIVEN( "A branch that fails" ) {
+    auto failing = v::make_single_deferred([](auto out) {
+      ::pushmi::set_error(out, std::make_exception_ptr(std::logic_error("branch")));
+    });
+    auto w = op::when_all<int, int>(op::just(1), failing);
+    int signals = 0;
+
+    WHEN( "the join is submitted" ) {
+      w | op::submit(
+        [&](auto){ signals += 100; },
+        [&](auto e) noexcept { signals += 1000; },
+        [&](){ signals += 10; });
+
+      THEN( "only the error is delivered" ) {
+        REQUIRE( signals == 1000 );
+      }
+    }
+  }
+
+  GIVEN( "A branch that is empty" ) {
+    auto w = op::when_all<int, int>(op::empty<int>(), op::just(2));
+    int signals = 0;
+
+    WHEN( "the join is submitted" ) {
+      w | op::submit(
+        [&](auto){ signals += 100; },
+        [&](auto e) noexcept { signals += 1000; },
+        [&](){ signals += 10; });
+
+      THEN( "only done is delivered" ) {
+        REQUIRE( signals == 10 );
+      }
+    }
+  }
+}
+
+SCENARIO( "when_all joins a range of senders", "[when_all]" ) {
+
+  GIVEN( "A vector of senders running on new threads" ) {
+    auto nt = v::new_thread();
+    auto make = [nt](int i){ return nt | op::transform([i](auto){ return i; }); };
+    std::vector<decltype(make(0))> senders;
+    for (int i = 0; i < 200; ++i) {
+      senders.push_back(make(i));
+    }
+
+    WHEN( "the result is waited on" ) {
+      auto values = op::when_all<int>(senders) | op::get<std::vector<int>>;
+
+      THEN( "every value is delivered in range order" ) {
+        REQUIRE( values.size() == 200 );
+        bool ordered = true;
+        for (int i = 0; i < 200; ++i) {
+          ordered = ordered && values[i] == i;
+        }
+        REQUIRE( ordered );
+      }
+    }
+  }
+
+  GIVEN( "A range of senders where one throws from submit" ) {
+    auto make = [](int i) {
+      return v::make_single_deferred([i](auto out) {
+        if (i == 2) {
+          throw std::runtime_error("submit");
+        }
+        ::pushmi::set_value(out, i);
+      });
+    };
+    std::vector<decltype(make(0))> senders;
+    for (int i = 0; i < 4; ++i) {
+      senders.push_back(make(i));
+    }
+    int signals = 0;
+
+    WHEN( "the join is submitted" ) {
+      op::when_all<int>(senders) | op::submit(
+        [&](auto){ signals += 100; },
+        [&](auto e) noexcept { signals += 1000; },
+        [&](){ signals += 10; });
+
+      THEN( "the exception is delivered as the error" ) {
+        REQUIRE( signals == 1000 );
+      }
+    }
+  }
+
+  GIVEN( "An empty range" ) {
+    std::vector<decltype(op::just(0))> senders;
+
+    WHEN( "the result is waited on" ) {
+      auto values = op::when_all<int>(senders) | op::get<std::vector<int>>;
+
+      THEN( "an empty vector is delivered" ) {
+        REQUIRE( values.empty() );
+      }
+    }
+  }
+}
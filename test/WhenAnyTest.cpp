@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include <stdexcept>
+
+#include "pushmi/flow_single_deferred.h"
+#include "pushmi/o/just.h"
+#include "pushmi/o/empty.h"
+#include "pushmi/o/when_any.h"
+#include "pushmi/o/submit.h"
+#include "pushmi/o/extension_operators.h"
+
+using namespace pushmi::aliases;
+
+SCENARIO( "when_any delivers the first result and cancels the others", "[when_any]" ) {
+
+  GIVEN( "A sender that holds its stop token and a sender with a value" ) {
+    mi::stop_token token;
+    bool stopped_at_submit = true;
+    auto slow = v::make_single_deferred([&](auto out) {
+      token = ::pushmi::get_stop_token(out);
+      stopped_at_submit = token.stop_requested();
+    });
+    auto w = op::when_any<int>(slow, op::just(42));
+
+    WHEN( "the race is waited on" ) {
+      auto result = w | op::get<int>;
+
+      THEN( "the value is delivered and the loser is asked to stop" ) {
+        REQUIRE( result == 42 );
+        REQUIRE( token.stop_possible() );
+        REQUIRE( !stopped_at_submit );
+        REQUIRE( token.stop_requested() );
+      }
+    }
+  }
+
+  GIVEN( "A flow sender that has started and a sender with a value" ) {
+    int cancels = 0;
+    auto up = v::make_none([&]() { ++cancels; });
+    auto flow = v::make_flow_single_deferred([&](auto out) {
+      ::pushmi::set_starting(out, up);
+    });
+    auto w = op::when_any<int>(flow, op::just(7));
+
+    WHEN( "the race is waited on" ) {
+      auto result = w | op::get<int>;
+
+      THEN( "the flow sender is cancelled through its up handle" ) {
+        REQUIRE( result == 7 );
+        REQUIRE( cancels == 1 );
+      }
+    }
+  }
+
+  GIVEN( "A sender that fails first" ) {
+    auto failing = v::make_single_deferred([](auto out) {
+      ::pushmi::set_error(out, std::make_exception_ptr(std::logic_error("first")));
+    });
+    auto w = op::when_any<int>(failing, op::just(1));
+    int signals = 0;
+
+    WHEN( "the race is submitted" ) {
+      w | op::submit(
+        [&](auto){ signals += 100; },
+        [&](auto e) noexcept { signals += 1000; },
+        [&](){ signals += 10; });
+
+      THEN( "only the error is delivered" ) {
+        REQUIRE( signals == 1000 );
+      }
+    }
+  }
+
+  GIVEN( "Senders that are all empty" ) {
+    auto w = op::when_any<int>(op::empty<int>(), op::empty<int>());
+    int signals = 0;
+
+    WHEN( "the race is submitted" ) {
+      w | op::submit(
+        [&](auto){ signals += 100; },
+        [&](auto e) noexcept { signals += 1000; },
+        [&](){ signals += 10; });
+
+      THEN( "done is delivered once" ) {
+        REQUIRE( signals == 10 );
+      }
+    }
+  }
+}
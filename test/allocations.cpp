@@ -0,0 +1,64 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "allocations.h"
+
+// the replacements of the global operator new count the allocations of each
+// thread and of the whole program. they replace the allocation functions of
+// the test program and of the benchmarks, so every form is replaced
+// together, allocating and freeing with malloc and free. they live apart
+// from the tests so that the tests do not inline them.
+
+namespace {
+thread_local std::uint64_t allocated = 0;
+std::atomic<std::uint64_t> allocated_by_all{0};
+} // namespace
+
+std::uint64_t pushmi_test::allocations() noexcept {
+  return allocated;
+}
+
+std::uint64_t pushmi_test::all_allocations() noexcept {
+  return allocated_by_all.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+  ++allocated;
+  allocated_by_all.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+void* operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return ::operator new(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return ::operator new(size, std::nothrow);
+}
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
@@ -0,0 +1,19 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <cstdint>
+
+namespace pushmi_test {
+
+// the calls to the global operator new made by this thread so far.
+// allocations.cpp replaces the allocation functions of the test program and
+// of the benchmarks to count them.
+std::uint64_t allocations() noexcept;
+
+// the calls to the global operator new made by every thread so far.
+std::uint64_t all_allocations() noexcept;
+
+} // namespace pushmi_test
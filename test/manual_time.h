@@ -0,0 +1,97 @@
+#pragma once
+// Copyright (c) 2018-present, Facebook, Inc.
+//
+// This source code is licensed under the MIT license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <chrono>
+#include <map>
+#include <memory>
+
+#include "pushmi/time_single_deferred.h"
+
+namespace pushmi_test {
+
+// a clock that only moves when the test advances it, with a time executor
+// whose timers wait for it. advance() runs the timers that come due, in the
+// order of their deadlines, on the calling thread. a timer whose receiver
+// has asked it to stop is completed with done, and freed, by the next
+// advance() without waiting for its deadline. not thread safe, the tests
+// submit and advance from one thread.
+class manual_time {
+ public:
+  using time_point = std::chrono::system_clock::time_point;
+
+ private:
+  struct timer {
+    virtual ~timer() = default;
+    virtual bool stopped() = 0;
+    virtual void fire(manual_time& t) = 0;
+    virtual void stop() = 0;
+  };
+  template <class Out>
+  struct timer_for : timer {
+    explicit timer_for(Out out) : out_(std::move(out)) {}
+    Out out_;
+    bool stopped() override {
+      return ::pushmi::get_stop_token(out_).stop_requested();
+    }
+    void fire(manual_time& t) override {
+      ::pushmi::set_value(out_, t.executor());
+    }
+    void stop() override {
+      ::pushmi::set_done(out_);
+    }
+  };
+
+  time_point now_{};
+  std::multimap<time_point, std::unique_ptr<timer>> timers_;
+  int submitted_ = 0;
+
+ public:
+  time_point now() const {
+    return now_;
+  }
+  // the timers submitted so far.
+  int submitted() const {
+    return submitted_;
+  }
+  // the timers that have neither run nor been stopped.
+  std::size_t waiting() const {
+    return timers_.size();
+  }
+
+  auto executor() {
+    return ::pushmi::make_time_single_deferred(
+      [this](time_point at, auto out) {
+        ++submitted_;
+        timers_.emplace(
+          at, std::make_unique<timer_for<decltype(out)>>(std::move(out)));
+      },
+      [this] { return now_; });
+  }
+
+  void advance(std::chrono::milliseconds by) {
+    now_ += by;
+    for (auto it = timers_.begin(); it != timers_.end();) {
+      if (it->second->stopped()) {
+        auto t = std::move(it->second);
+        it = timers_.erase(it);
+        t->stop();
+      } else {
+        ++it;
+      }
+    }
+    while (!timers_.empty() && timers_.begin()->first <= now_) {
+      auto t = std::move(timers_.begin()->second);
+      timers_.erase(timers_.begin());
+      if (t->stopped()) {
+        t->stop();
+      } else {
+        t->fire(*this);
+      }
+    }
+  }
+};
+
+} // namespace pushmi_test